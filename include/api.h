@@ -1,8 +1,14 @@
 #pragma once
 #include "utils.h"
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 namespace cycles {
 
@@ -10,6 +16,13 @@ using Id = sf::Uint8; ///< The type of the player's unique identifier
 
 constexpr auto SERVER_IP = "127.0.0.1";
 
+/**
+ * @brief Wire protocol version, sent to the server after the player name at
+ * connect time. The server requires at least version 2 (run-length encoded
+ * keyframes and delta frames) and disconnects older clients.
+ */
+constexpr sf::Uint8 PROTOCOL_VERSION = 2;
+
 /**
  * @brief A representation of a player
  */
@@ -46,7 +59,7 @@ struct GameState {
 
   int frameNumber; ///< The number of the current frame
 
-  GameState() = default;
+  GameState() { playerIndex.fill(-1); }
 
   /**
    * @brief Get the value of a cell in the grid
@@ -81,9 +94,153 @@ struct GameState {
            position.y < gridHeight;
   }
 
+  /**
+   * @brief Count the free cells among the four neighbors of a position
+   *
+   * Neighbors outside the grid count as occupied.
+   *
+   * @param position The position whose neighborhood to inspect
+   * @return int The number of free neighboring cells (0 to 4)
+   */
+  int countFreeNeighbors(sf::Vector2i position) const;
+
+  /**
+   * @brief Get a free-cell mask for up to 64 cells of a row
+   *
+   * Bit i of the result is 1 if the cell at (x + i, y) is free; bits past
+   * the right edge of the grid are 0. Backed by the packed occupancy bitset,
+   * so scanning a region costs a couple of word loads per 64 cells.
+   *
+   * @param y The row to inspect
+   * @param x The column of the first cell (bit 0)
+   * @return std::uint64_t The free-cell mask
+   */
+  std::uint64_t getRowFreeMask(int y, int x) const;
+
+  /**
+   * @brief Check if every cell of a rectangle is free
+   *
+   * @param topLeft The top-left corner of the rectangle
+   * @param size The width and height of the rectangle (in cells)
+   * @return true if the rectangle lies inside the grid and is entirely free
+   * @return false otherwise
+   */
+  bool isRectEmpty(sf::Vector2i topLeft, sf::Vector2i size) const;
+
+  /**
+   * @brief Get a player by their unique identifier in O(1)
+   *
+   * Backed by an id-indexed table rebuilt at deserialization, so looking up
+   * any opponent costs an array access instead of scanning players.
+   *
+   * @param id The identifier of the player
+   * @return const Player* The player, or nullptr if no such player is alive
+   */
+  const Player *getPlayerById(Id id) const {
+    return playerIndex[id] >= 0 ? &players[playerIndex[id]] : nullptr;
+  }
+
+  /**
+   * @brief Get the bot's own player in O(1)
+   *
+   * The server reports the assigned id in the connect handshake and the
+   * Connection stamps it into every received state, so bots no longer need
+   * the per-frame name scan over players.
+   *
+   * @return const Player* The own player, or nullptr (e.g. once the bot has
+   * died, or when connected to a server that predates id reporting)
+   */
+  const Player *getSelf() const { return getPlayerById(selfId); }
+
+  /**
+   * @brief Populate the state directly from server-side data
+   *
+   * Used by in-process harnesses (the simulation target, tests) to hand the
+   * game state to bot code without a round-trip through sf::Packet. Reuses
+   * the existing grid and player storage, so refreshing the same object
+   * every frame performs no steady-state allocations.
+   *
+   * @param grid The server's grid, row-major, gridWidth x gridHeight
+   * @param gridWidth The width of the grid (in cells)
+   * @param gridHeight The height of the grid (in cells)
+   * @param players The players currently in the game
+   * @param frameNumber The number of the current frame
+   */
+  void assign(const std::vector<Id> &grid, int gridWidth, int gridHeight,
+              const std::vector<Player> &players, int frameNumber);
+
 private:
   friend Connection;
-  GameState(sf::Packet &packet);
+
+  /**
+   * @brief Packed occupancy bitset, one bit per cell (1 = occupied)
+   *
+   * Rebuilt at deserialization so the bulk queries above stay in sync with
+   * the grid.
+   */
+  std::vector<std::uint64_t> occupancy;
+
+  std::array<int, 256> playerIndex; ///< id -> index into players, -1 if absent
+
+  Id selfId = 0; ///< Id of the receiving player, stamped by the Connection
+
+  void rebuildOccupancy();
+
+  void rebuildPlayerIndex();
+
+  bool cellOccupied(int index) const {
+    return (occupancy[index >> 6] >> (index & 63)) & 1;
+  }
+  // Deserializes a state packet. The server sends a full-grid keyframe on
+  // join and per-cell deltas afterwards; deltas are applied on top of
+  // previousGrid (the grid of the previously received state).
+  GameState(sf::Packet &packet, const std::vector<Id> &previousGrid = {});
+
+  // Deserializes a state packet into this object, reusing the existing grid,
+  // player and name storage. Deltas are applied in place, so the object must
+  // hold the previously received state.
+  void readFrom(sf::Packet &packet);
+};
+
+/**
+ * @brief A reusable flood-fill engine over the game grid
+ *
+ * Replaces the ad-hoc BFS implementations bots write to estimate territory.
+ * The engine keeps flat visited/queue scratch buffers between calls, so
+ * per-frame fills perform no heap allocation once warmed up. Not thread
+ * safe; use one instance per bot.
+ */
+class AreaEstimator {
+public:
+  /**
+   * @brief Count the free cells reachable from a position
+   *
+   * Breadth-first fill through free cells using 4-neighbor moves. The
+   * starting position itself is not counted and may be occupied (e.g. the
+   * bot's own head).
+   *
+   * @param state The game state to fill over
+   * @param position The starting position
+   * @return int The number of reachable free cells
+   */
+  int computeReachableArea(const GameState &state, sf::Vector2i position);
+
+  /**
+   * @brief Partition the free cells among the players (Voronoi by distance)
+   *
+   * Multi-source breadth-first fill seeded at every player's head. Each free
+   * cell is claimed by the player that reaches it first; at equal distance
+   * the player earlier in state.players wins.
+   *
+   * @param state The game state to fill over
+   * @return std::vector<int> For each entry of state.players, the number of
+   * free cells that player reaches first
+   */
+  std::vector<int> computeVoronoiAreas(const GameState &state);
+
+private:
+  std::vector<std::uint8_t> visited;
+  std::vector<int> queue;
 };
 
 /**
@@ -95,6 +252,27 @@ class Connection {
   int frameNumber = 0;
   int lastFrameSent = -1;
   std::string playerName;
+  Id myId = 0; ///< Id assigned by the server at connect time (0 if unknown)
+  // Liveness flag fed by the send/receive statuses; a Disconnected result
+  // clears it, so isActive needs no per-frame getpeername syscall
+  bool active = false;
+  std::vector<Id> lastGrid; ///< Grid of the last received state, the base for delta packets
+
+  // Async mode state (see enableAsyncMode). The background thread owns the
+  // socket: it receives states into latestState and answers each frame with
+  // the queued move, or repeats the previous one if none arrives in time.
+  std::thread asyncThread;
+  std::mutex asyncMutex;
+  std::condition_variable moveQueued;
+  GameState latestState;
+  bool hasNewState = false;
+  Direction pendingMove = Direction::north;
+  bool movePending = false;
+  Direction lastMoveSent = Direction::north;
+  std::atomic<bool> asyncRunning{false};
+  std::atomic<bool> asyncConnected{false};
+
+  void asyncLoop();
 
 public:
   /**
@@ -105,6 +283,16 @@ public:
    */
   sf::Color connect(std::string playerName);
 
+  /**
+   * @brief Get the player's unique identifier
+   *
+   * Assigned by the server at connect time. Returns 0 when connected to a
+   * server that predates id reporting.
+   *
+   * @return Id The player's identifier
+   */
+  Id getMyId() const { return myId; }
+
   /**
    * @brief Send the player's move to the server
    *
@@ -127,6 +315,20 @@ public:
    */
   GameState receiveGameState();
 
+  /**
+   * @brief Receive the game state from the server into an existing object
+   *
+   * In-place variant of receiveGameState(): deserializes into the storage
+   * already held by state, so steady-state frames perform no heap
+   * allocations. Pass the same GameState object every frame and do not mix
+   * with the returning overload, since delta packets are applied on top of
+   * the previously received state.
+   *
+   * @param state The state received on the previous frame, overwritten with
+   * the new one
+   */
+  void receiveGameState(GameState &state);
+
   /**
    * @brief Check if the connection is active
    *
@@ -134,6 +336,40 @@ public:
    * @return false if the connection is not active
    */
   bool isActive();
+
+  /**
+   * @brief Switch the connection to asynchronous mode
+   *
+   * Starts a background thread that owns the socket: it receives game states
+   * as they arrive and replies to the server within its deadline, repeating
+   * the last queued move if no new one has been queued yet. Use
+   * pollGameState() and queueMove() afterwards; do not mix with the blocking
+   * receiveGameState()/sendMove() calls. Call after connect().
+   */
+  void enableAsyncMode();
+
+  /**
+   * @brief Get the most recent game state without blocking
+   *
+   * Only valid in asynchronous mode.
+   *
+   * @param state Overwritten with the latest received state
+   * @return true if a state newer than the last poll was available
+   * @return false if nothing new has arrived yet
+   */
+  bool pollGameState(GameState &state);
+
+  /**
+   * @brief Queue the player's move without blocking
+   *
+   * Only valid in asynchronous mode. The background thread sends the move in
+   * reply to the next game state from the server.
+   *
+   * @param direction The direction of the move
+   */
+  void queueMove(Direction direction);
+
+  ~Connection();
 };
 
 } // namespace cycles
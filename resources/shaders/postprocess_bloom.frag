@@ -0,0 +1,61 @@
+# version 400 core
+// Fused post-processing pass: the old chain rendered a quarter-scale bloom
+// tile (postprocess.frag) into an intermediate texture and then combined it
+// with the scene (bloom.frag). This shader computes the same lod-2 bloom
+// gather directly around each fragment and composites it in one pass, so
+// post-processing costs a single full-screen draw and no intermediate
+// targets.
+#define colorRange 24.0
+
+uniform sampler2D iChannel0;
+uniform vec2 iResolution;
+
+bool isWhite(vec4 color){
+  return color.r == 1.0 && color.g == 1.0 && color.b == 1.0;
+}
+
+vec4 getColorAt(vec2 coord){
+  vec4 color = texture(iChannel0, coord);
+  color.a = 1.0;
+  //If the pixel is white, return black
+  if(isWhite(color)){
+    return vec4(0.0, 0.0, 0.0, 1.0);
+  }
+  return color;
+}
+
+vec3 jodieReinhardTonemap(vec3 c){
+    float l = dot(c, vec3(0.2126, 0.7152, 0.0722));
+    vec3 tc = c / (c + 1.0);
+    return mix(c / (l + 1.0), tc, tc);
+}
+
+vec3 makeBloom(vec2 uv){
+  vec2 pixelSize = 1.0 / vec2(iResolution.x, iResolution.y);
+  // exp2(2): the sample spacing of the old lod-2 tile
+  vec2 scale = 4.0 * pixelSize;
+  vec3 bloom = vec3(0.0);
+  float totalWeight = 0.0;
+  int range = 5;
+  for (int i = -range; i < range; i++) {
+    for (int j = -range; j < range; j++) {
+      float wg = pow(1.0-length(vec2(i,j)) * 0.125,2.0);
+      vec2 look_coord = vec2(i,j) * scale + uv;
+      bloom += pow(getColorAt(look_coord).rgb, vec3(2.2))*wg;
+      totalWeight += wg;
+    }
+  }
+  bloom /= totalWeight;
+  return bloom;
+}
+
+void main(){
+  vec2 fragCoord = gl_FragCoord.xy;
+  vec2 uv = fragCoord.xy / iResolution.xy;
+  vec3 color = pow(texture(iChannel0, uv).rgb*colorRange*0.6, vec3(2.2));
+  color = pow(color, vec3(2.2));
+  color += pow(makeBloom(uv) * colorRange, vec3(2.2));
+  color = pow(color, vec3(1.0 / 2.2));
+  color = jodieReinhardTonemap(color);
+  gl_FragColor = vec4(color,1.0);
+}
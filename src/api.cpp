@@ -1,10 +1,17 @@
 #include "api.h"
 #include <SFML/Network.hpp>
+#include <algorithm>
+#include <array>
 #include <spdlog/spdlog.h>
 
 namespace cycles {
 
-GameState::GameState(sf::Packet &packet) {
+GameState::GameState(sf::Packet &packet, const std::vector<Id> &previousGrid) {
+  grid = previousGrid;
+  readFrom(packet);
+}
+
+void GameState::readFrom(sf::Packet &packet) {
   packet >> gridWidth >> gridHeight;
   sf::Uint32 playerCount;
   packet >> playerCount;
@@ -12,20 +19,229 @@ GameState::GameState(sf::Packet &packet) {
   for (sf::Uint32 i = 0; i < playerCount; ++i) {
     int x, y;
     sf::Uint8 r, g, b;
-    Id playerId;
-    std::string playerName;
-    packet >> x >> y >> r >> g >> b >> playerName >> playerId >> frameNumber;
-    players[i] = {playerName, sf::Color(r, g, b), sf::Vector2i(x, y), playerId};
+    // Read directly into the stored player so the name string can reuse its
+    // existing capacity
+    auto &player = players[i];
+    packet >> x >> y >> r >> g >> b >> player.name >> player.id >> frameNumber;
+    player.color = sf::Color(r, g, b);
+    player.position = sf::Vector2i(x, y);
   }
-  grid.resize(gridWidth * gridHeight);
-  for (auto &cell : grid) {
-    packet >> cell;
+  sf::Uint8 packetType;
+  packet >> packetType;
+  if (packetType == 0) {
+    // Keyframe: the packet carries the full grid
+    grid.resize(gridWidth * gridHeight);
+    for (auto &cell : grid) {
+      packet >> cell;
+    }
+  } else if (packetType == 2) {
+    // Run-length encoded keyframe: (count, Id) runs covering the grid
+    grid.resize(gridWidth * gridHeight);
+    size_t pos = 0;
+    while (pos < grid.size()) {
+      sf::Uint16 runLength;
+      Id value;
+      // A failed extraction or an empty run (which would never advance) is
+      // as malformed as an overrun
+      if (!(packet >> runLength >> value) || runLength == 0 ||
+          pos + runLength > grid.size()) {
+        spdlog::critical("Malformed run-length encoded grid");
+        exit(1);
+      }
+      std::fill_n(grid.begin() + pos, runLength, value);
+      pos += runLength;
+    }
+  } else {
+    // Delta: apply the changed cells in place on top of the previous grid
+    if (grid.size() != static_cast<size_t>(gridWidth * gridHeight)) {
+      spdlog::critical("Received a delta game state without a keyframe");
+      exit(1);
+    }
+    sf::Uint32 changeCount;
+    packet >> changeCount;
+    for (sf::Uint32 i = 0; i < changeCount; ++i) {
+      sf::Uint32 index;
+      Id value;
+      if (!(packet >> index >> value) || index >= grid.size()) {
+        spdlog::critical("Malformed delta game state");
+        exit(1);
+      }
+      grid[index] = value;
+    }
   }
   //Check that the whole packet was read
   if (!packet.endOfPacket()) {
     spdlog::critical("There is still data left in the packet");
     exit(1);
   }
+  rebuildOccupancy();
+  rebuildPlayerIndex();
+}
+
+void GameState::assign(const std::vector<Id> &grid, int gridWidth,
+                       int gridHeight, const std::vector<Player> &players,
+                       int frameNumber) {
+  this->grid = grid;
+  this->gridWidth = gridWidth;
+  this->gridHeight = gridHeight;
+  this->players = players;
+  this->frameNumber = frameNumber;
+  rebuildOccupancy();
+  rebuildPlayerIndex();
+}
+
+void GameState::rebuildPlayerIndex() {
+  playerIndex.fill(-1);
+  for (size_t i = 0; i < players.size(); ++i) {
+    playerIndex[players[i].id] = static_cast<int>(i);
+  }
+}
+
+void GameState::rebuildOccupancy() {
+  occupancy.assign((grid.size() + 63) / 64, 0);
+  for (size_t i = 0; i < grid.size(); ++i) {
+    if (grid[i] != 0) {
+      occupancy[i >> 6] |= std::uint64_t(1) << (i & 63);
+    }
+  }
+}
+
+int GameState::countFreeNeighbors(sf::Vector2i position) const {
+  static const std::array<sf::Vector2i, 4> offsets = {
+      sf::Vector2i(0, -1), sf::Vector2i(1, 0), sf::Vector2i(0, 1),
+      sf::Vector2i(-1, 0)};
+  int free = 0;
+  for (const auto &offset : offsets) {
+    const auto neighbor = position + offset;
+    if (isInsideGrid(neighbor) &&
+        !cellOccupied(neighbor.y * gridWidth + neighbor.x)) {
+      free++;
+    }
+  }
+  return free;
+}
+
+std::uint64_t GameState::getRowFreeMask(int y, int x) const {
+  const int index = y * gridWidth + x;
+  const int word = index >> 6;
+  const int shift = index & 63;
+  // The 64 cells starting at index span at most two occupancy words
+  std::uint64_t occupied = occupancy[word] >> shift;
+  if (shift != 0 && static_cast<size_t>(word + 1) < occupancy.size()) {
+    occupied |= occupancy[word + 1] << (64 - shift);
+  }
+  std::uint64_t freeMask = ~occupied;
+  // Mask out bits past the right edge of the row
+  const int cellsInRow = gridWidth - x;
+  if (cellsInRow < 64) {
+    freeMask &= (std::uint64_t(1) << cellsInRow) - 1;
+  }
+  return freeMask;
+}
+
+bool GameState::isRectEmpty(sf::Vector2i topLeft, sf::Vector2i size) const {
+  if (size.x <= 0 || size.y <= 0) {
+    return true;
+  }
+  if (!isInsideGrid(topLeft) ||
+      !isInsideGrid(topLeft + size - sf::Vector2i(1, 1))) {
+    return false;
+  }
+  for (int y = topLeft.y; y < topLeft.y + size.y; ++y) {
+    // Word-at-a-time scan of the row span
+    for (int x = topLeft.x; x < topLeft.x + size.x; x += 64) {
+      const int span = std::min(64, topLeft.x + size.x - x);
+      std::uint64_t spanMask = span == 64 ? ~std::uint64_t(0)
+                                          : (std::uint64_t(1) << span) - 1;
+      if ((getRowFreeMask(y, x) & spanMask) != spanMask) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int AreaEstimator::computeReachableArea(const GameState &state,
+                                        sf::Vector2i position) {
+  const int width = state.gridWidth;
+  const int height = state.gridHeight;
+  visited.assign(width * height, 0);
+  queue.clear();
+  auto tryPush = [&](int x, int y) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+      return;
+    }
+    const int index = y * width + x;
+    if (visited[index] || state.grid[index] != 0) {
+      return;
+    }
+    visited[index] = 1;
+    queue.push_back(index);
+  };
+  // Mark the start as visited (without counting it) so the fill cannot
+  // re-enter it through a neighbor
+  if (state.isInsideGrid(position)) {
+    visited[position.y * width + position.x] = 1;
+  }
+  tryPush(position.x, position.y - 1);
+  tryPush(position.x + 1, position.y);
+  tryPush(position.x, position.y + 1);
+  tryPush(position.x - 1, position.y);
+  size_t head = 0;
+  while (head < queue.size()) {
+    const int index = queue[head++];
+    const int x = index % width;
+    const int y = index / width;
+    tryPush(x, y - 1);
+    tryPush(x + 1, y);
+    tryPush(x, y + 1);
+    tryPush(x - 1, y);
+  }
+  return static_cast<int>(queue.size());
+}
+
+std::vector<int> AreaEstimator::computeVoronoiAreas(const GameState &state) {
+  const int width = state.gridWidth;
+  const int height = state.gridHeight;
+  // visited doubles as the owner table: 0 = unclaimed, owner index + 1
+  // otherwise (player counts are bounded well below 255)
+  visited.assign(width * height, 0);
+  queue.clear();
+  std::vector<int> areas(state.players.size(), 0);
+  auto tryPush = [&](int x, int y, std::uint8_t owner) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+      return;
+    }
+    const int index = y * width + x;
+    if (visited[index] || state.grid[index] != 0) {
+      return;
+    }
+    visited[index] = owner;
+    queue.push_back(index);
+  };
+  // Seed the fill at every head; the heads themselves are occupied cells and
+  // are not counted
+  for (size_t i = 0; i < state.players.size(); ++i) {
+    const auto &position = state.players[i].position;
+    const auto owner = static_cast<std::uint8_t>(i + 1);
+    tryPush(position.x, position.y - 1, owner);
+    tryPush(position.x + 1, position.y, owner);
+    tryPush(position.x, position.y + 1, owner);
+    tryPush(position.x - 1, position.y, owner);
+  }
+  size_t head = 0;
+  while (head < queue.size()) {
+    const int index = queue[head++];
+    const auto owner = visited[index];
+    areas[owner - 1]++;
+    const int x = index % width;
+    const int y = index / width;
+    tryPush(x, y - 1, owner);
+    tryPush(x + 1, y, owner);
+    tryPush(x, y + 1, owner);
+    tryPush(x - 1, y, owner);
+  }
+  return areas;
 }
 
 namespace detail {
@@ -46,8 +262,10 @@ std::shared_ptr<sf::TcpSocket> establishLink() {
   return socket;
 }
 
-void sendPacket(std::shared_ptr<sf::TcpSocket> socket, sf::Packet &packet,
-                bool blocking = true) {
+// Returns the final socket status instead of aborting, so callers can fold
+// a Disconnected result into their liveness state
+sf::Socket::Status sendPacket(std::shared_ptr<sf::TcpSocket> socket,
+                              sf::Packet &packet, bool blocking = true) {
   int attempts = 0;
   bool blockingState = socket->isBlocking();
   socket->setBlocking(blocking);
@@ -59,17 +277,12 @@ void sendPacket(std::shared_ptr<sf::TcpSocket> socket, sf::Packet &packet,
     }
     attempts++;
   }
-  if (status != sf::Socket::Done) {
-    spdlog::critical("Failed to send packet to server");
-    spdlog::critical("Reason: {}", socketErrorToString(status));
-    exit(1);
-  }
   socket->setBlocking(blockingState);
+  return status;
 }
 
-sf::Packet receivePacket(std::shared_ptr<sf::TcpSocket> socket,
-                         bool blocking = true) {
-  sf::Packet packet;
+sf::Socket::Status receivePacket(std::shared_ptr<sf::TcpSocket> socket,
+                                 sf::Packet &packet, bool blocking = true) {
   bool blockingState = socket->isBlocking();
   socket->setBlocking(blocking);
   sf::Socket::Status status = sf::Socket::NotReady;
@@ -81,21 +294,27 @@ sf::Packet receivePacket(std::shared_ptr<sf::TcpSocket> socket,
     }
     attempts++;
   }
-  if (status != sf::Socket::Done) {
-    spdlog::critical("Failed to receive packet from server");
-    spdlog::critical("Reason: {}", socketErrorToString(status));
-    exit(1);
-  }
   socket->setBlocking(blockingState);
-  return packet;
+  return status;
 }
 
 std::shared_ptr<sf::TcpSocket> connectToServer(std::string playerName) {
   auto socket = detail::establishLink();
-  // Send name to server
+  // Send name, protocol version and match id to the server. The match id
+  // (CYCLES_MATCH, default 0) selects the match on a tournament server;
+  // single-match servers ignore it.
+  sf::Uint16 matchId = 0;
+  if (const char *match = std::getenv("CYCLES_MATCH")) {
+    matchId = static_cast<sf::Uint16>(std::stoi(match));
+  }
   sf::Packet namePacket;
-  namePacket << playerName;
-  detail::sendPacket(socket, namePacket);
+  namePacket << playerName << PROTOCOL_VERSION << matchId;
+  if (auto status = detail::sendPacket(socket, namePacket);
+      status != sf::Socket::Done) {
+    spdlog::critical("Failed to send name to server");
+    spdlog::critical("Reason: {}", socketErrorToString(status));
+    exit(1);
+  }
   return socket;
 }
 
@@ -108,15 +327,27 @@ sf::Color Connection::connect(std::string playerName) {
   }
   socket = detail::connectToServer(playerName);
   sf::Color color;
-  sf::Packet colorPacket = detail::receivePacket(socket);
+  sf::Packet colorPacket;
+  if (auto status = detail::receivePacket(socket, colorPacket);
+      status != sf::Socket::Done) {
+    spdlog::critical("Failed to receive color from server");
+    spdlog::critical("Reason: {}", socketErrorToString(status));
+    exit(1);
+  }
   sf::Uint8 r, g, b;
   if (!(colorPacket >> r >> g >> b)) {
     spdlog::critical("Failed to receive color from server");
     exit(1);
   }
   color = sf::Color(r, g, b);
+  // Servers that report the assigned id append it after the color; older
+  // ones do not, leaving myId at 0
+  if (!colorPacket.endOfPacket()) {
+    colorPacket >> myId;
+  }
   spdlog::info("{}: Assigned color: R={} G={} B={}", playerName,
                static_cast<int>(r), static_cast<int>(g), static_cast<int>(b));
+  active = true;
   return color;
 }
 
@@ -129,20 +360,138 @@ void Connection::sendMove(Direction direction) {
   spdlog::debug("Sending move");
   sf::Packet packet;
   packet << getDirectionValue(direction);
-  detail::sendPacket(socket, packet);
+  if (detail::sendPacket(socket, packet) != sf::Socket::Done) {
+    spdlog::warn("Lost connection to server while sending move");
+    active = false;
+    return;
+  }
   lastFrameSent = frameNumber;
 }
 
 GameState Connection::receiveGameState() {
   spdlog::debug("Receiving game state");
-  auto packet = detail::receivePacket(socket);
-  GameState state(packet);
+  sf::Packet packet;
+  if (detail::receivePacket(socket, packet) != sf::Socket::Done) {
+    spdlog::warn("Lost connection to server while receiving game state");
+    active = false;
+    // An empty state: no players, zero-sized grid, the last frame number
+    GameState state;
+    state.gridWidth = 0;
+    state.gridHeight = 0;
+    state.frameNumber = frameNumber;
+    return state;
+  }
+  GameState state(packet, lastGrid);
+  state.selfId = myId;
+  lastGrid = state.grid;
   frameNumber = state.frameNumber;
   return state;
 }
 
+void Connection::receiveGameState(GameState &state) {
+  spdlog::debug("Receiving game state");
+  sf::Packet packet;
+  if (detail::receivePacket(socket, packet) != sf::Socket::Done) {
+    spdlog::warn("Lost connection to server while receiving game state");
+    active = false;
+    return;
+  }
+  state.readFrom(packet);
+  state.selfId = myId;
+  frameNumber = state.frameNumber;
+}
+
 bool Connection::isActive() {
-  return socket->getRemoteAddress() != sf::IpAddress::None;
+  if (asyncRunning) {
+    return asyncConnected;
+  }
+  // Maintained from the send/receive statuses, so the per-frame liveness
+  // check costs no syscall (getRemoteAddress performs a getpeername)
+  return active;
+}
+
+void Connection::enableAsyncMode() {
+  if (socket == nullptr) {
+    spdlog::critical("enableAsyncMode called before connect");
+    exit(1);
+  }
+  if (asyncRunning) {
+    spdlog::warn("Connection is already in asynchronous mode");
+    return;
+  }
+  asyncRunning = true;
+  asyncConnected = true;
+  asyncThread = std::thread(&Connection::asyncLoop, this);
+}
+
+void Connection::asyncLoop() {
+  socket->setBlocking(true);
+  // Poll with a selector timeout instead of blocking in receive, so
+  // shutdown only has to flip asyncRunning: SFML sockets are not thread
+  // safe, so the destructor must never touch the socket while this thread
+  // may be inside receive/send on it
+  sf::SocketSelector selector;
+  selector.add(*socket);
+  while (asyncRunning) {
+    if (!selector.wait(sf::milliseconds(100))) {
+      continue;
+    }
+    sf::Packet packet;
+    if (socket->receive(packet) != sf::Socket::Done) {
+      asyncConnected = false;
+      break;
+    }
+    Direction move;
+    {
+      std::unique_lock lock(asyncMutex);
+      latestState.readFrom(packet);
+      latestState.selfId = myId;
+      frameNumber = latestState.frameNumber;
+      hasNewState = true;
+      // Give the bot a moment to queue a move for this frame; fall back to
+      // repeating the previous one so the server's deadline is never missed
+      moveQueued.wait_for(lock, std::chrono::milliseconds(25),
+                          [this] { return movePending; });
+      move = movePending ? pendingMove : lastMoveSent;
+      movePending = false;
+      lastMoveSent = move;
+    }
+    sf::Packet movePacket;
+    movePacket << getDirectionValue(move);
+    if (socket->send(movePacket) != sf::Socket::Done) {
+      asyncConnected = false;
+      break;
+    }
+  }
+}
+
+bool Connection::pollGameState(GameState &state) {
+  std::scoped_lock lock(asyncMutex);
+  if (!hasNewState) {
+    return false;
+  }
+  state = latestState;
+  hasNewState = false;
+  return true;
+}
+
+void Connection::queueMove(Direction direction) {
+  {
+    std::scoped_lock lock(asyncMutex);
+    pendingMove = direction;
+    movePending = true;
+  }
+  moveQueued.notify_one();
+}
+
+Connection::~Connection() {
+  if (asyncRunning) {
+    // The background thread re-checks the flag at least every selector
+    // timeout, so joining is enough; touching the socket from this thread
+    // would race with a receive/send in flight
+    asyncRunning = false;
+    asyncThread.join();
+  }
 }
 
 
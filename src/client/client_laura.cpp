@@ -165,12 +165,9 @@ class BotClient {
 
   // receives the current game state from the server
   void receiveGameState() {
-    state = connection.receiveGameState();
-    for (const auto &player : state.players) {
-      if (player.name == name) {
-        my_player = player;
-        break;
-      }
+    connection.receiveGameState(state); // in-place refresh, no per-frame allocations
+    if (const Player *self = state.getSelf()) { // O(1), no name scan
+      my_player = *self;
     }
   }
 
@@ -64,11 +64,8 @@ class BotClient {
 
   void receiveGameState() {
     state = connection.receiveGameState();
-    for (const auto &player : state.players) {
-      if (player.name == name) {
-        my_player = player;
-        break;
-      }
+    if (const Player *self = state.getSelf()) {
+      my_player = *self;
     }
   }
 
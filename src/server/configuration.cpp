@@ -16,6 +16,13 @@ namespace cycles_server{
     if (config["maxClients"]) {
       maxClients = config["maxClients"].as<int>();
     }
+    if (config["tickRate"]) {
+      tickRate = config["tickRate"].as<int>();
+      if (tickRate <= 0) {
+        spdlog::error("tickRate must be positive, using default of 30");
+        tickRate = 30;
+      }
+    }
     if (config["gridWidth"]) {
       gridWidth = config["gridWidth"].as<int>();
     }
@@ -34,11 +41,26 @@ namespace cycles_server{
     if (config["enablePostProcessing"]) {
       enablePostProcessing = config["enablePostProcessing"].as<bool>();
     }
+    if (config["headless"]) {
+      headless = config["headless"].as<bool>();
+    }
+    if (config["headlessWaitTime"]) {
+      headlessWaitTime = config["headlessWaitTime"].as<int>();
+    }
+    if (config["fastForward"]) {
+      fastForward = config["fastForward"].as<bool>();
+    }
+    if (config["replayFile"]) {
+      replayFile = config["replayFile"].as<std::string>();
+    }
 
-    std::set<std::string> knownParameters = {"maxClients", "gridWidth",
-                                             "gridHeight", "gameWidth",
-                                             "gameHeight", "gameBannerHeight",
-					     "enablePostProcessing"};
+    std::set<std::string> knownParameters = {"maxClients", "tickRate",
+                                             "gridWidth", "gridHeight",
+                                             "gameWidth", "gameHeight",
+                                             "gameBannerHeight",
+					     "enablePostProcessing",
+					     "headless", "headlessWaitTime",
+					     "fastForward", "replayFile"};
     // Warn if there are unknown parameters
     for (const auto &it : config) {
       if (knownParameters.find(it.first.as<std::string>()) ==
@@ -3,20 +3,21 @@
 #include <random>
 #include <set>
 #include <spdlog/spdlog.h>
+#include <unordered_map>
 
 namespace cycles_server {
 
 namespace detail {
 
 template <typename T>
-std::map<Id, T> removeNonExistentPlayers(std::map<Id, T> directions,
-                                         const std::map<Id, Player> &players) {
-  for (auto [id, direction] : directions) {
-    if (players.find(id) == players.end()) {
-      directions.erase(id);
+void removeNonExistentPlayers(std::map<Id, T> &directions, const Game &game) {
+  for (auto it = directions.begin(); it != directions.end();) {
+    if (!game.hasPlayer(it->first)) {
+      it = directions.erase(it);
+    } else {
+      ++it;
     }
   }
-  return directions;
 }
   std::tuple<int, int, int> hslToRgb(float h, float s, float l) {
     float c = (1 - std::abs(2 * l - 1)) * s;
@@ -71,35 +72,75 @@ sf::Color getRandomColor(auto rng) {
 
 } // namespace detail
 
+Game::Game(Configuration conf)
+    : conf(conf), grid(conf.gridWidth * conf.gridHeight, 0),
+      rng(std::random_device()()) {
+  playerIndex.fill(-1);
+  // Every cell starts out free
+  freeCells.resize(grid.size());
+  cellToFreeIndex.resize(grid.size());
+  for (size_t i = 0; i < grid.size(); ++i) {
+    freeCells[i] = static_cast<int>(i);
+    cellToFreeIndex[i] = static_cast<int>(i);
+  }
+#ifdef CYCLES_FIXED_GRID_WIDTH
+  if (conf.gridWidth != gridWidth() || conf.gridHeight != gridHeight()) {
+    spdlog::critical("This server was compiled for a fixed {}x{} grid but "
+                     "the configuration asks for {}x{}",
+                     gridWidth(), gridHeight(), conf.gridWidth,
+                     conf.gridHeight);
+    exit(1);
+  }
+#endif
+}
+
 Id Game::addPlayer(const std::string &name) {
   static std::vector<uint32_t> palette = detail::generateColorPalette(300);
+  const sf::Color color(palette[idCounter]);
+  // Draw the spawn cell straight from the free-cell index: O(1) however
+  // crowded the grid is, instead of rejection sampling occupied cells
+  if (freeCells.empty()) {
+    spdlog::critical("No free cell left to spawn player {}", name);
+    exit(1);
+  }
+  std::uniform_int_distribution<size_t> dist(0, freeCells.size() - 1);
+  const int cell = freeCells[dist(rng)];
+  const sf::Vector2i position(cell % gridWidth(), cell / gridWidth());
+  return addPlayer(name, position, color);
+}
+
+Id Game::addPlayer(const std::string &name, sf::Vector2i position,
+                   sf::Color color) {
   gameStarted = true;
   Player newPlayer;
   newPlayer.name = name;
-  newPlayer.color = sf::Color(palette[idCounter]);
+  newPlayer.color = color;
   newPlayer.id = idCounter;
-  std::uniform_real_distribution<float> dist(0, 1.0);
-  do {
-    newPlayer.position.x = conf.gridWidth * dist(rng);
-    newPlayer.position.y = conf.gridHeight * dist(rng);
-  } while (getCell(newPlayer.position.x, newPlayer.position.y));
-  getCell(newPlayer.position.x, newPlayer.position.y) = newPlayer.id;
-  players[idCounter] = newPlayer;
+  newPlayer.position = position;
+  setCell(newPlayer.position.x, newPlayer.position.y, newPlayer.id);
+  playerIndex[newPlayer.id] = static_cast<int>(players.size());
+  players.push_back(newPlayer);
   idCounter++;
   return idCounter - 1;
 }
 
 void Game::removePlayer(Id id) {
-  auto player_it = players.find(id);
-  if (player_it == players.end()) {
+  const int index = playerIndex[id];
+  if (index < 0) {
     return;
   }
-  auto &player = player_it->second;
-  getCell(player.position.x, player.position.y) = 0;
+  auto &player = players[index];
+  setCell(player.position.x, player.position.y, 0);
   for (auto tail : player.tail) {
-    getCell(tail.x, tail.y) = 0;
+    setCell(tail.x, tail.y, 0);
+  }
+  // Swap-remove to keep the storage dense
+  playerIndex[id] = -1;
+  if (index != static_cast<int>(players.size()) - 1) {
+    players[index] = std::move(players.back());
+    playerIndex[players[index].id] = index;
   }
-  players.erase(id);
+  players.pop_back();
 }
 
 void Game::movePlayers(std::map<Id, Direction> directions) {
@@ -107,18 +148,18 @@ void Game::movePlayers(std::map<Id, Direction> directions) {
     return;
   }
   max_tail_length = 55 + frame / 100;
-  // Sanitize directions
-  directions = detail::removeNonExistentPlayers(directions, players);
+  // Sanitize directions (erases in place)
+  detail::removeNonExistentPlayers(directions, *this);
   std::map<Id, sf::Vector2i> newPositions;
   // Transform directions to positions
   for (const auto &[id, direction] : directions) {
-    auto it = players.find(id);
-    if (it == players.end()) {
+    const auto *playerPtr = findPlayer(id);
+    if (playerPtr == nullptr) {
       continue;
     }
-    const auto &player = it->second;
+    const auto &player = *playerPtr;
     const sf::Vector2i newPos = player.position + getDirectionVector(direction);
-    spdlog::debug(
+    SPDLOG_DEBUG(
         "Game: Player {} trying to move to ({},{}) from ({},{}) in frame {}",
         player.name, newPos.x, newPos.y, player.position.x, player.position.y,
         frame);
@@ -132,14 +173,14 @@ void Game::movePlayers(std::map<Id, Direction> directions) {
   }
   // Move remaining players
   for (const auto &[id, newPos] : newPositions) {
-    auto it = players.find(id);
-    if (it == players.end()) {
+    auto *playerPtr = findPlayer(id);
+    if (playerPtr == nullptr) {
       continue;
     }
-    auto &player = it->second;
-    getCell(newPos.x, newPos.y) = player.id;
+    auto &player = *playerPtr;
+    setCell(newPos.x, newPos.y, player.id);
     if (player.tail.size() > max_tail_length) {
-      getCell(player.tail.back().x, player.tail.back().y) = 0;
+      setCell(player.tail.back().x, player.tail.back().y, 0);
       player.tail.pop_back();
     }
     player.tail.push_front(player.position);
@@ -148,13 +189,13 @@ void Game::movePlayers(std::map<Id, Direction> directions) {
 }
 
 bool Game::legalMove(sf::Vector2i newPos) {
-  if (newPos.x < 0 || newPos.x >= conf.gridWidth || newPos.y < 0 ||
-      newPos.y >= conf.gridHeight) {
-    spdlog::debug("Game: Moved out of bounds");
+  if (newPos.x < 0 || newPos.x >= gridWidth() || newPos.y < 0 ||
+      newPos.y >= gridHeight()) {
+    SPDLOG_DEBUG("Game: Moved out of bounds");
     return false;
   }
   if (getCell(newPos.x, newPos.y) != 0) {
-    spdlog::debug("Game: Moved where player {} is",
+    SPDLOG_DEBUG("Game: Moved where player {} is",
                   int(getCell(newPos.x, newPos.y)));
     return false;
   }
@@ -163,26 +204,37 @@ bool Game::legalMove(sf::Vector2i newPos) {
 
 std::set<Id> Game::checkCollisions(std::map<Id, sf::Vector2i> newPositions) {
   std::set<Id> colliding;
-  // If two players are trying to go to the same position, remove both
-  for (const auto &[id1, pos1] : newPositions) {
-    for (const auto &[id2, pos2] : newPositions) {
-      if (id1 < id2 && pos1 == pos2) {
-        spdlog::debug("Game: Players {} and {} collided", id1, id2);
-        colliding.insert(id1);
-        colliding.insert(id2);
-      }
+  // If two players are trying to go to the same position, remove both.
+  // Index the proposed positions by grid cell so same-target collisions are
+  // found in a single linear pass instead of comparing every pair.
+  std::unordered_map<int, Id> claimedCells;
+  claimedCells.reserve(newPositions.size());
+  for (const auto &[id, pos] : newPositions) {
+    if (pos.x < 0 || pos.x >= gridWidth() || pos.y < 0 ||
+        pos.y >= gridHeight()) {
+      continue; // Out-of-bounds proposals are handled by legalMove below
+    }
+    auto [it, inserted] =
+        claimedCells.try_emplace(pos.y * gridWidth() + pos.x, id);
+    if (!inserted) {
+      SPDLOG_DEBUG("Game: Players {} and {} collided", it->second, id);
+      colliding.insert(it->second);
+      colliding.insert(id);
     }
   }
   // If a player is trying to go to a position where another player is, remove
   // the player
   for (const auto &[id, newPos] : newPositions) {
-    auto player = players[id];
-    spdlog::debug(
+    if (!hasPlayer(id)) {
+      continue;
+    }
+    [[maybe_unused]] const auto &player = getPlayer(id);
+    SPDLOG_DEBUG(
         "Game: Player {} trying to move to ({},{}) from ({},{}) in frame {}",
         player.name, newPos.x, newPos.y, player.position.x, player.position.y,
         frame);
     if (!legalMove(newPos)) {
-      spdlog::debug("Game: Player {} tried to move to an illegal position",
+      SPDLOG_DEBUG("Game: Player {} tried to move to an illegal position",
                     player.name);
       colliding.insert(id);
     }
@@ -1,7 +1,9 @@
 #pragma once
 #include "server.h"
+#include <array>
+#include <atomic>
 #include <map>
-#include <mutex>
+#include <memory>
 #include <random>
 #include <set>
 #include <vector>
@@ -15,29 +17,69 @@ class Game {
   Id idCounter = 1;
   int frame = 0;
   bool gameStarted = false;
-  std::map<Id, Player> players;
+  // Players are stored densely (swap-remove on erase) with an Id-indexed
+  // table into the vector, so iteration is contiguous and lookups are O(1)
+  std::vector<Player> players;
+  std::array<int, 256> playerIndex;
   std::vector<sf::Uint8> grid;
+  std::vector<std::pair<int, Id>> changedCells;
+  // Free-cell index: freeCells holds the indices of every empty grid cell
+  // (swap-remove on occupy), cellToFreeIndex maps a cell back to its slot in
+  // freeCells (-1 when occupied). Maintained by setCell, so spawning a late
+  // joiner is a single uniform draw instead of rejection sampling.
+  std::vector<int> freeCells;
+  std::vector<int> cellToFreeIndex;
   std::mt19937 rng;
-  std::mutex gameMutex;
 
 public:
-  Game(Configuration conf)
-      : conf(conf), grid(conf.gridWidth * conf.gridHeight, 0),
-        rng(std::random_device()()) {}
+  // Immutable copy of everything the renderer needs for one frame. The game
+  // thread publishes a fresh snapshot at the end of each tick with an atomic
+  // pointer swap; the render thread reads the latest one lock-free, so the
+  // two never contend and the renderer never observes a half-updated tick.
+  struct Snapshot {
+    int frame = 0;
+    bool gameOver = false;
+    std::vector<Player> players;
+  };
+
+  Game(Configuration conf);
 
   Id addPlayer(const std::string &name);
 
+  // Deterministic variant used by replay playback: spawns the player at the
+  // recorded position with the recorded color instead of rolling the rng
+  Id addPlayer(const std::string &name, sf::Vector2i position, sf::Color color);
+
   void removePlayer(Id id);
 
   void movePlayers(std::map<Id, Direction> directions);
 
   const auto &getGrid() { return grid; }
 
-  auto getPlayers() {
-    std::scoped_lock lock(gameMutex);
-    return players;
+  const auto &getChangedCells() { return changedCells; }
+
+  void clearChangedCells() { changedCells.clear(); }
+
+  // Cheap read path for the game-loop thread: no lock, no copy
+  const std::vector<Player> &getPlayers() { return players; }
+
+  // Called by the game thread once per tick (and per join, so the splash
+  // screen stays current)
+  void publishSnapshot() {
+    renderSnapshot.store(
+        std::make_shared<const Snapshot>(Snapshot{frame, isGameOver(), players}),
+        std::memory_order_release);
+  }
+
+  // Lock-free read path for the render thread
+  std::shared_ptr<const Snapshot> getSnapshot() const {
+    return renderSnapshot.load(std::memory_order_acquire);
   }
 
+  bool hasPlayer(Id id) const { return playerIndex[id] >= 0; }
+
+  const Player &getPlayer(Id id) const { return players[playerIndex[id]]; }
+
   void setFrame(int frame) { this->frame = frame; }
 
   int getFrame() { return frame; }
@@ -46,7 +88,47 @@ public:
 
 private:
 
-  Id &getCell(int x, int y) { return grid[y * conf.gridWidth + x]; }
+  std::atomic<std::shared_ptr<const Snapshot>> renderSnapshot{
+      std::make_shared<const Snapshot>()};
+
+  // Tournament builds always run one grid size; configuring with
+  // -DCYCLES_FIXED_GRID=ON (src/server/CMakeLists.txt) bakes the dimensions
+  // in as compile-time constants, so grid indexing strength-reduces and the
+  // grid loops can unroll and vectorize. The default build keeps reading
+  // the size from the configuration.
+#ifdef CYCLES_FIXED_GRID_WIDTH
+  static constexpr int gridWidth() { return CYCLES_FIXED_GRID_WIDTH; }
+  static constexpr int gridHeight() { return CYCLES_FIXED_GRID_HEIGHT; }
+#else
+  int gridWidth() const { return conf.gridWidth; }
+  int gridHeight() const { return conf.gridHeight; }
+#endif
+
+  Player *findPlayer(Id id) {
+    return playerIndex[id] >= 0 ? &players[playerIndex[id]] : nullptr;
+  }
+
+  Id &getCell(int x, int y) { return grid[y * gridWidth() + x]; }
+
+  // All grid writes go through here so that the per-frame list of changed
+  // cells and the free-cell index stay in sync with the grid (used for the
+  // delta state protocol and for O(1) spawn placement).
+  void setCell(int x, int y, Id value) {
+    const int index = y * gridWidth() + x;
+    Id &cell = grid[index];
+    if (cell == 0 && value != 0) {
+      const int slot = cellToFreeIndex[index];
+      freeCells[slot] = freeCells.back();
+      cellToFreeIndex[freeCells[slot]] = slot;
+      freeCells.pop_back();
+      cellToFreeIndex[index] = -1;
+    } else if (cell != 0 && value == 0) {
+      cellToFreeIndex[index] = static_cast<int>(freeCells.size());
+      freeCells.push_back(index);
+    }
+    cell = value;
+    changedCells.emplace_back(index, value);
+  }
 
   bool legalMove(sf::Vector2i newPos);
 
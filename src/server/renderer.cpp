@@ -1,6 +1,7 @@
 #include "renderer.h"
 #include "resources.h"
 #include <SFML/Graphics.hpp>
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <spdlog/spdlog.h>
@@ -14,46 +15,29 @@ void PostProcess::create(sf::Vector2i windowSize) {
                      "again without post processing enabled.");
     exit(1);
   }
-  auto postProcessShaderSource =
-      cycles_resources::getResourceFile("resources/shaders/postprocess.frag");
+  auto postProcessShaderSource = cycles_resources::getResourceFile(
+      "resources/shaders/postprocess_bloom.frag");
   postProcessShader.loadFromMemory(std::string(postProcessShaderSource.begin(),
                                                postProcessShaderSource.end()),
                                    sf::Shader::Fragment);
-  auto bloomShaderSource =
-      cycles_resources::getResourceFile("resources/shaders/bloom.frag");
-  bloomShader.loadFromMemory(
-      std::string(bloomShaderSource.begin(), bloomShaderSource.end()),
-      sf::Shader::Fragment);
   if (!postProcessShader.isAvailable()) {
     spdlog::critical("Shader not available");
     exit(1);
   }
-  if (!bloomShader.isAvailable()) {
-    spdlog::critical("Bloom shader not available");
-    exit(1);
-  }
-  renderTexture.create(windowSize.x, windowSize.y);
-  renderTexture.setSmooth(true);
-  channel1.create(windowSize.x, windowSize.y);
-  channel1.setSmooth(true);
+  // The resolution only changes with the window, so bind it once here
+  postProcessShader.setUniform("iResolution",
+                               sf::Glsl::Vec2(windowSize.x, windowSize.y));
 }
 
 void PostProcess::apply(sf::RenderWindow &window, sf::RenderTexture &channel0) {
-  auto windowSize = sf::Glsl::Vec2(window.getSize().x, window.getSize().y);
-  postProcessShader.setUniform("iResolution", windowSize);
-  bloomShader.setUniform("iResolution", windowSize);
-  renderTexture.clear(sf::Color::Black);
-  channel1.clear(sf::Color::Black);
-  sf::RectangleShape bkg(windowSize);
-  bkg.setFillColor(sf::Color::Black);
-  renderTexture.draw(bkg);
-  channel1.draw(bkg);
-  postProcessShader.setUniform("iChannel0", channel0.getTexture());
-  channel1.draw(sf::Sprite(channel0.getTexture()), &postProcessShader);
-  channel1.display();
-  bloomShader.setUniform("iChannel0", channel0.getTexture());
-  bloomShader.setUniform("iChannel1", channel1.getTexture());
-  window.draw(sf::Sprite(renderTexture.getTexture()), &bloomShader);
+  // Scene, bloom and tonemap are fused in one shader, so the whole effect
+  // is a single full-screen draw: no intermediate targets to clear and no
+  // per-frame sprite or uniform setup
+  if (sprite.getTexture() != &channel0.getTexture()) {
+    sprite.setTexture(channel0.getTexture(), true);
+    postProcessShader.setUniform("iChannel0", channel0.getTexture());
+  }
+  window.draw(sprite, &postProcessShader);
 }
 
 // Rendering Logic
@@ -61,8 +45,11 @@ GameRenderer::GameRenderer(Configuration conf)
     : window(sf::VideoMode(conf.gameWidth,
                            conf.gameHeight + conf.gameBannerHeight),
              "Cycles++"),
-      conf(conf) {
-  window.setFramerateLimit(60);
+      tailVertices(sf::Quads), conf(conf) {
+  // Refresh fast enough to show every tick; fast-forward runs unpaced, so
+  // cap the window at a sane rate and let it skip frames
+  window.setFramerateLimit(conf.fastForward ? 60
+                                            : std::max(conf.tickRate, 60));
   try {
     auto fs = cycles_resources::getResourceFile("resources/SAIBA-45.ttf");
     font.loadFromMemory(fs.begin(), fs.size());
@@ -70,6 +57,16 @@ GameRenderer::GameRenderer(Configuration conf)
     spdlog::warn("No font loaded. Text rendering may not work correctly.");
   }
   renderTexture.create(window.getSize().x, window.getSize().y);
+  trailTexture.create(window.getSize().x, window.getSize().y);
+  // Style the banner labels once; only their strings change per frame
+  frameText.setFont(font);
+  frameText.setCharacterSize(22);
+  frameText.setPosition(10, 10);
+  frameText.setFillColor(sf::Color::White);
+  playersText.setFont(font);
+  playersText.setCharacterSize(22);
+  playersText.setPosition(10, 40);
+  playersText.setFillColor(sf::Color::White);
   if (conf.enablePostProcessing) {
     postProcess = std::make_unique<PostProcess>();
     postProcess->create(sf::Vector2i(window.getSize().x, window.getSize().y));
@@ -77,6 +74,10 @@ GameRenderer::GameRenderer(Configuration conf)
 }
 
 void GameRenderer::render(std::shared_ptr<Game> game) {
+  // Lock-free: the game thread publishes an immutable snapshot at the end
+  // of each tick; every render helper reads the same one
+  const auto snapshot = game->getSnapshot();
+  const auto &players = snapshot->players;
   window.clear(sf::Color::Black);
   // // Draw grid
   // sf::RectangleShape cell(sf::Vector2f(conf.cellSize - 1, conf.cellSize -
@@ -87,11 +88,11 @@ void GameRenderer::render(std::shared_ptr<Game> game) {
   // 	window.draw(cell);
   //   }
   // }
-  renderPlayers(game);
-  if (game->isGameOver()) {
-    renderGameOver(game);
+  renderPlayers(players, snapshot->frame);
+  if (snapshot->gameOver) {
+    renderGameOver(players);
   }
-  renderBanner(game);
+  renderBanner(snapshot->frame, players);
   window.display();
 }
 
@@ -112,17 +113,78 @@ void GameRenderer::handleEvents(
   }
 }
 
-void GameRenderer::renderPlayers(std::shared_ptr<Game> game) {
+void GameRenderer::updateTrailTexture(const std::vector<Player> &players,
+                                      int frame) {
+  const int offset_y = conf.gameBannerHeight + 0;
+  const int offset_x = 0;
+  const auto cellSize = conf.cellSize;
+  auto appendQuad = [&](sf::Vector2i cell, sf::Color color) {
+    const float x = cell.x * cellSize + offset_x;
+    const float y = cell.y * cellSize + offset_y;
+    tailVertices.append({{x, y}, color});
+    tailVertices.append({{x + cellSize, y}, color});
+    tailVertices.append({{x + cellSize, y + cellSize}, color});
+    tailVertices.append({{x, y + cellSize}, color});
+  };
+  // The incremental path is only sound if the player set is unchanged since
+  // the last drawn tick
+  bool samePlayers = players.size() == lastTails.size();
+  for (const auto &player : players) {
+    samePlayers = samePlayers && lastTails.count(player.id) > 0;
+  }
+  if (trailTextureValid && frame == lastTrailFrame && samePlayers) {
+    return; // window refresh without a new tick: the texture is current
+  }
+  tailVertices.clear();
+  if (!trailTextureValid || frame != lastTrailFrame + 1 || !samePlayers) {
+    // Discontinuity (startup, join, removal, playback seek): redraw the
+    // whole board once
+    trailTexture.clear(sf::Color::Black);
+    for (const auto &player : players) {
+      for (auto tail : player.tail) {
+        appendQuad(tail, player.color);
+      }
+    }
+  } else {
+    // Steady state: each player adds at most one tail cell (the cell its
+    // head just vacated) and frees at most one (the old tail end), so only
+    // those dirty cells are drawn
+    for (const auto &player : players) {
+      const auto &[lastBack, lastSize] = lastTails[player.id];
+      if (!player.tail.empty()) {
+        appendQuad(player.tail.front(), player.color);
+      }
+      const bool backVacated =
+          lastSize > 0 && player.tail.size() <= lastSize &&
+          (player.tail.empty() || player.tail.back() != lastBack);
+      if (backVacated) {
+        appendQuad(lastBack, sf::Color::Black);
+      }
+    }
+  }
+  trailTexture.draw(tailVertices);
+  trailTexture.display();
+  trailTextureValid = true;
+  lastTrailFrame = frame;
+  lastTails.clear();
+  for (const auto &player : players) {
+    lastTails[player.id] = {player.tail.empty() ? player.position
+                                                : player.tail.back(),
+                            player.tail.size()};
+  }
+}
+
+void GameRenderer::renderPlayers(const std::vector<Player> &players,
+                                 int frame) {
   const int offset_y = conf.gameBannerHeight + 0;
   const int offset_x = 0;
   auto cellSize = conf.cellSize;
-  auto windowSize = sf::Glsl::Vec2(window.getSize().x, window.getSize().y);
+  updateTrailTexture(players, frame);
+  // The clear already paints the background; no full-screen rect needed
   renderTexture.clear(sf::Color::Black);
-  sf::RectangleShape bkg(windowSize);
-  bkg.setFillColor(sf::Color::Black);
-  renderTexture.draw(bkg);
-
-  for (const auto &[id, player] : game->getPlayers()) {
+  // Composite the persistent trail layer, then the heads on top
+  renderTexture.draw(sf::Sprite(trailTexture.getTexture()));
+  for (const auto &player : players) {
     sf::CircleShape playerShape(cellSize);
     // Make the head of the player darker
     auto darkerColor = player.color;
@@ -143,39 +205,45 @@ void GameRenderer::renderPlayers(std::shared_ptr<Game> game) {
         (player.position.x) * cellSize - cellSize / 2 - 1 + offset_x,
         (player.position.y) * cellSize - cellSize / 2 - 1 + offset_y);
     renderTexture.draw(borderShape);
-    // Draw tail
-    for (auto tail : player.tail) {
-      sf::RectangleShape tailShape(sf::Vector2f(cellSize, cellSize));
-      tailShape.setFillColor(player.color);
-      tailShape.setPosition(tail.x * cellSize + offset_x,
-                            tail.y * cellSize + offset_y);
-      renderTexture.draw(tailShape);
-    }
   }
   renderTexture.display();
   if (postProcess)
     postProcess->apply(window, renderTexture);
   else
     window.draw(sf::Sprite(renderTexture.getTexture()));
-  for (const auto &[id, player] : game->getPlayers()) {
-    sf::Text nameText(player.name, font, 30);
-    nameText.setFillColor(sf::Color::White);
-    nameText.setOutlineThickness(2);
-    nameText.setOutlineColor(sf::Color::Black);
-    nameText.setPosition(player.position.x * cellSize - 20 + offset_x,
-                         player.position.y * cellSize - 20 + offset_y);
-    window.draw(nameText);
+  // Name labels are cached per player id, so the glyph layout is done once
+  // at join; only the position moves with the head
+  for (const auto &player : players) {
+    auto it = nameTexts.find(player.id);
+    if (it == nameTexts.end()) {
+      sf::Text nameText(player.name, font, 30);
+      nameText.setFillColor(sf::Color::White);
+      nameText.setOutlineThickness(2);
+      nameText.setOutlineColor(sf::Color::Black);
+      it = nameTexts.emplace(player.id, std::move(nameText)).first;
+    }
+    it->second.setPosition(player.position.x * cellSize - 20 + offset_x,
+                           player.position.y * cellSize - 20 + offset_y);
+    window.draw(it->second);
+  }
+  // Drop labels of removed players
+  for (auto it = nameTexts.begin(); it != nameTexts.end();) {
+    const Id id = it->first;
+    const bool alive =
+        std::any_of(players.begin(), players.end(),
+                    [id](const Player &player) { return player.id == id; });
+    it = alive ? std::next(it) : nameTexts.erase(it);
   }
 }
 
-void GameRenderer::renderGameOver(std::shared_ptr<Game> game) {
+void GameRenderer::renderGameOver(const std::vector<Player> &players) {
   sf::Text gameOverText("Game Over", font, 60);
   gameOverText.setOutlineThickness(3);
   gameOverText.setOutlineColor(sf::Color::White);
   gameOverText.setFillColor(sf::Color::Black);
   gameOverText.setPosition(conf.gameWidth / 2 - 150, conf.gameHeight / 2 - 30);
-  if (game->getPlayers().size() > 0) {
-    auto winner = game->getPlayers().begin()->second.name;
+  if (players.size() > 0) {
+    auto winner = players.front().name;
     sf::Text winnerText("Winner: " + winner, font, 40);
     winnerText.setFillColor(sf::Color::Black);
     winnerText.setOutlineThickness(3);
@@ -186,30 +254,34 @@ void GameRenderer::renderGameOver(std::shared_ptr<Game> game) {
   window.draw(gameOverText);
 }
 
-void GameRenderer::renderBanner(std::shared_ptr<Game> game) {
+void GameRenderer::renderBanner(int frame,
+                                const std::vector<Player> &players) {
   // Draw a banner at the top
   sf::RectangleShape banner(
       sf::Vector2f(conf.gameWidth, conf.gameBannerHeight - 20));
   banner.setFillColor(sf::Color::Black);
   banner.setPosition(0, 0);
   window.draw(banner);
-  // Draw the frame number
-  sf::Text frameText("Frame: " + std::to_string(game->getFrame()), font, 22);
-  frameText.setPosition(10, 10);
-  frameText.setFillColor(sf::Color::White);
+  // Draw the frame number, reformatting only when it changed
+  if (frame != lastFrameShown) {
+    frameText.setString("Frame: " + std::to_string(frame));
+    lastFrameShown = frame;
+  }
   window.draw(frameText);
-  // Draw the number of players
-  sf::Text playersText("Players: " + std::to_string(game->getPlayers().size()),
-                       font, 22);
-  playersText.setPosition(10, 40);
-  playersText.setFillColor(sf::Color::White);
+  // Draw the number of players, likewise
+  if (static_cast<int>(players.size()) != lastPlayerCountShown) {
+    playersText.setString("Players: " + std::to_string(players.size()));
+    lastPlayerCountShown = static_cast<int>(players.size());
+  }
   window.draw(playersText);
 }
 
 void GameRenderer::renderSplashScreen(std::shared_ptr<Game> game) {
+  const auto snapshot = game->getSnapshot();
+  const auto &players = snapshot->players;
   window.clear(sf::Color::Black);
-  renderPlayers(game);
-  renderBanner(game);
+  renderPlayers(players, snapshot->frame);
+  renderBanner(snapshot->frame, players);
   sf::Text splashText("Waiting for players\npress SPACE to start", font, 30);
   splashText.setFillColor(sf::Color::Black);
   splashText.setOutlineThickness(2);
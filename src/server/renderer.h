@@ -3,15 +3,17 @@
 #include "game_logic.h"
 #include <SFML/Graphics.hpp>
 #include <functional>
+#include <map>
 
 
 namespace cycles_server{
 // Rendering Logic
 class PostProcess{
+  // One fused shader (scene + bloom gather + tonemap): see
+  // resources/shaders/postprocess_bloom.frag. No intermediate render
+  // targets; the sprite and uniform bindings are cached across frames.
   sf::Shader postProcessShader;
-  sf::Shader bloomShader;
-  sf::RenderTexture renderTexture;
-  sf::RenderTexture channel1;
+  sf::Sprite sprite;
 public:
   PostProcess(){}
   void create(sf::Vector2i windowSize);
@@ -22,6 +24,23 @@ class GameRenderer {
   sf::RenderWindow window;
   sf::Font font;
   sf::RenderTexture renderTexture;
+  // Persistent trail layer: tail cells accumulate here across frames and
+  // only the per-tick deltas are drawn (see updateTrailTexture), so the
+  // trail cost per frame is O(players) instead of O(total trail length)
+  sf::RenderTexture trailTexture;
+  sf::VertexArray tailVertices; // reused quad batch for the dirty tail cells
+  bool trailTextureValid = false;
+  int lastTrailFrame = -1;
+  // Per player: tail end cell and tail length at the last drawn tick, used
+  // to detect vacated tail ends
+  std::map<Id, std::pair<sf::Vector2i, size_t>> lastTails;
+  // Cached text objects: glyph layout only reruns when the underlying value
+  // changes, not on every frame
+  sf::Text frameText;
+  sf::Text playersText;
+  int lastFrameShown = -1;
+  int lastPlayerCountShown = -1;
+  std::map<Id, sf::Text> nameTexts; // one label per player, keyed by id
   const Configuration conf;
   std::unique_ptr<PostProcess> postProcess;
 
@@ -37,10 +56,12 @@ public:
   void renderSplashScreen(std::shared_ptr<Game> game);
 
 private:
-  void renderPlayers(std::shared_ptr<Game> game);
+  void renderPlayers(const std::vector<Player> &players, int frame);
+
+  void updateTrailTexture(const std::vector<Player> &players, int frame);
 
-  void renderGameOver(std::shared_ptr<Game> game);
+  void renderGameOver(const std::vector<Player> &players);
 
-  void renderBanner(std::shared_ptr<Game> game);
+  void renderBanner(int frame, const std::vector<Player> &players);
 };
 }
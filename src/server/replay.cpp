@@ -0,0 +1,235 @@
+#include "replay.h"
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+namespace cycles_server {
+
+namespace {
+
+constexpr char replayMagic[4] = {'C', 'Y', 'R', 'P'};
+constexpr sf::Uint8 replayVersion = 1;
+
+// Replay buffers are flushed to the writer thread once they reach this size
+constexpr size_t flushThreshold = 64 * 1024;
+
+enum EventType : sf::Uint8 {
+  JoinEvent = 0,
+  LeaveEvent = 1,
+  TickEvent = 2,
+};
+
+template <typename T> void readRaw(std::istream &in, T &value) {
+  in.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+} // namespace
+
+ReplayRecorder::ReplayRecorder(const std::string &path,
+                               const Configuration &conf)
+    : out(path, std::ios::binary | std::ios::trunc) {
+  if (!out) {
+    spdlog::critical("Failed to open replay file {}", path);
+    exit(1);
+  }
+  spdlog::info("Recording replay to {}", path);
+  append(replayMagic, sizeof(replayMagic));
+  append(&replayVersion, sizeof(replayVersion));
+  append(&conf.gridWidth, sizeof(conf.gridWidth));
+  append(&conf.gridHeight, sizeof(conf.gridHeight));
+  writerThread = std::thread(&ReplayRecorder::writerLoop, this);
+}
+
+ReplayRecorder::~ReplayRecorder() {
+  {
+    std::scoped_lock lock(writerMutex);
+    if (!buffer.empty()) {
+      pendingChunks.push_back(std::move(buffer));
+    }
+    stopping = true;
+  }
+  chunkReady.notify_one();
+  writerThread.join();
+}
+
+void ReplayRecorder::append(const void *data, size_t size) {
+  const char *bytes = static_cast<const char *>(data);
+  buffer.insert(buffer.end(), bytes, bytes + size);
+}
+
+void ReplayRecorder::flush() {
+  if (buffer.size() < flushThreshold) {
+    return;
+  }
+  {
+    std::scoped_lock lock(writerMutex);
+    pendingChunks.push_back(std::move(buffer));
+  }
+  buffer.clear();
+  chunkReady.notify_one();
+}
+
+void ReplayRecorder::writerLoop() {
+  std::vector<std::vector<char>> chunks;
+  while (true) {
+    {
+      std::unique_lock lock(writerMutex);
+      chunkReady.wait(lock,
+                      [this] { return stopping || !pendingChunks.empty(); });
+      std::swap(chunks, pendingChunks);
+      if (chunks.empty() && stopping) {
+        break;
+      }
+    }
+    for (const auto &chunk : chunks) {
+      out.write(chunk.data(), chunk.size());
+    }
+    chunks.clear();
+  }
+  out.flush();
+}
+
+void ReplayRecorder::recordJoin(int frame, const Player &player) {
+  const sf::Uint8 type = JoinEvent;
+  append(&type, sizeof(type));
+  append(&frame, sizeof(frame));
+  append(&player.id, sizeof(player.id));
+  const auto nameLength = static_cast<sf::Uint16>(player.name.size());
+  append(&nameLength, sizeof(nameLength));
+  append(player.name.data(), nameLength);
+  append(&player.color.r, sizeof(player.color.r));
+  append(&player.color.g, sizeof(player.color.g));
+  append(&player.color.b, sizeof(player.color.b));
+  append(&player.position.x, sizeof(player.position.x));
+  append(&player.position.y, sizeof(player.position.y));
+  flush();
+}
+
+void ReplayRecorder::recordLeave(int frame, Id id) {
+  const sf::Uint8 type = LeaveEvent;
+  append(&type, sizeof(type));
+  append(&frame, sizeof(frame));
+  append(&id, sizeof(id));
+  flush();
+}
+
+void ReplayRecorder::recordTick(int frame,
+                                const std::map<Id, Direction> &directions) {
+  const sf::Uint8 type = TickEvent;
+  append(&type, sizeof(type));
+  append(&frame, sizeof(frame));
+  const auto count = static_cast<sf::Uint16>(directions.size());
+  append(&count, sizeof(count));
+  for (const auto &[id, direction] : directions) {
+    const auto value = static_cast<sf::Uint8>(getDirectionValue(direction));
+    append(&id, sizeof(id));
+    append(&value, sizeof(value));
+  }
+  flush();
+}
+
+bool playReplay(const std::string &path, const Configuration &conf,
+                Game &game) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    spdlog::error("Failed to open replay file {}", path);
+    return false;
+  }
+  char magic[4];
+  in.read(magic, sizeof(magic));
+  if (std::memcmp(magic, replayMagic, sizeof(magic)) != 0) {
+    spdlog::error("{} is not a replay file", path);
+    return false;
+  }
+  sf::Uint8 version;
+  readRaw(in, version);
+  if (version != replayVersion) {
+    spdlog::error("Unsupported replay version {}", version);
+    return false;
+  }
+  int gridWidth, gridHeight;
+  readRaw(in, gridWidth);
+  readRaw(in, gridHeight);
+  if (gridWidth != conf.gridWidth || gridHeight != conf.gridHeight) {
+    // Recorded positions are absolute grid cells; feeding them into a game
+    // with different dimensions would index outside its grid
+    spdlog::error("Replay {} was recorded on a {}x{} grid but the server is "
+                  "configured for {}x{}",
+                  path, gridWidth, gridHeight, conf.gridWidth,
+                  conf.gridHeight);
+    return false;
+  }
+  spdlog::info("Playing back replay {} ({}x{} grid)", path, gridWidth,
+               gridHeight);
+  while (true) {
+    sf::Uint8 type;
+    readRaw(in, type);
+    if (!in) {
+      break; // End of replay
+    }
+    int frame;
+    readRaw(in, frame);
+    switch (type) {
+    case JoinEvent: {
+      Id id;
+      readRaw(in, id);
+      sf::Uint16 nameLength;
+      readRaw(in, nameLength);
+      std::string name(nameLength, '\0');
+      in.read(name.data(), nameLength);
+      sf::Uint8 r, g, b;
+      readRaw(in, r);
+      readRaw(in, g);
+      readRaw(in, b);
+      sf::Vector2i position;
+      readRaw(in, position.x);
+      readRaw(in, position.y);
+      if (position.x < 0 || position.x >= gridWidth || position.y < 0 ||
+          position.y >= gridHeight) {
+        spdlog::error("Replay is corrupt: player {} spawns at ({},{}) "
+                      "outside the {}x{} grid",
+                      name, position.x, position.y, gridWidth, gridHeight);
+        return false;
+      }
+      const Id assigned =
+          game.addPlayer(name, position, sf::Color(r, g, b));
+      if (assigned != id) {
+        spdlog::error("Replay divergence: player {} was assigned id {} "
+                      "instead of {}",
+                      name, assigned, id);
+        return false;
+      }
+      break;
+    }
+    case LeaveEvent: {
+      Id id;
+      readRaw(in, id);
+      game.removePlayer(id);
+      break;
+    }
+    case TickEvent: {
+      sf::Uint16 count;
+      readRaw(in, count);
+      std::map<Id, Direction> directions;
+      for (sf::Uint16 i = 0; i < count; ++i) {
+        Id id;
+        sf::Uint8 value;
+        readRaw(in, id);
+        readRaw(in, value);
+        directions[id] = cycles::getDirectionFromValue(value);
+      }
+      game.setFrame(frame);
+      game.movePlayers(directions);
+      game.clearChangedCells();
+      break;
+    }
+    default:
+      spdlog::error("Unknown replay event type {}", type);
+      return false;
+    }
+  }
+  spdlog::info("Replay finished at frame {} with {} players left",
+               game.getFrame(), game.getPlayers().size());
+  return true;
+}
+
+} // namespace cycles_server
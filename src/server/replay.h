@@ -0,0 +1,61 @@
+#pragma once
+#include "game_logic.h"
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cycles_server {
+
+/**
+ * Records a game to an append-only binary replay file: one Join event per
+ * addPlayer (with the spawn position and color, so playback is
+ * deterministic), one Leave event per server-side removal, and one Tick
+ * event per frame with the directions fed to movePlayers. Serialization
+ * happens on the game-loop thread into an in-memory buffer; a background
+ * writer thread flushes completed buffers to disk so file I/O never stalls
+ * the tick. The format is host-endian and intended for same-machine
+ * record/replay.
+ */
+class ReplayRecorder {
+public:
+  ReplayRecorder(const std::string &path, const Configuration &conf);
+
+  ~ReplayRecorder();
+
+  void recordJoin(int frame, const Player &player);
+
+  void recordLeave(int frame, Id id);
+
+  void recordTick(int frame, const std::map<Id, Direction> &directions);
+
+private:
+  void append(const void *data, size_t size);
+
+  void flush();
+
+  void writerLoop();
+
+  std::ofstream out;
+  std::vector<char> buffer;
+  std::vector<std::vector<char>> pendingChunks;
+  std::mutex writerMutex;
+  std::condition_variable chunkReady;
+  std::thread writerThread;
+  bool stopping = false;
+};
+
+/**
+ * Feeds a Game instance from a replay file instead of sockets, re-running
+ * the recorded joins, leaves and per-frame directions. Returns false if the
+ * file cannot be read, its grid dimensions do not match the given
+ * configuration, or a recorded spawn position lies outside the grid.
+ */
+bool playReplay(const std::string &path, const Configuration &conf,
+                Game &game);
+
+} // namespace cycles_server
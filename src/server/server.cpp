@@ -1,29 +1,97 @@
 #include "server.h"
 #include "game_logic.h"
 #include "renderer.h"
+#include "replay.h"
 #include <SFML/Network.hpp>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 #include <thread>
 #include <vector>
 
 using namespace cycles_server;
 
+// Log2-bucketed histogram of phase durations in microseconds. Buckets are
+// preallocated and recording is a shift and an increment, so sampling the
+// hot path costs next to nothing and never allocates.
+struct LatencyHistogram {
+  std::array<uint64_t, 32> buckets{};
+  uint64_t samples = 0;
+
+  void record(int64_t micros) {
+    const auto value = static_cast<uint64_t>(std::max<int64_t>(micros, 0));
+    buckets[std::min<int>(std::bit_width(value), buckets.size() - 1)]++;
+    samples++;
+  }
+
+  // Upper bound (in microseconds) of the bucket containing the percentile
+  int64_t percentile(double p) const {
+    const uint64_t target = static_cast<uint64_t>(p * samples);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      seen += buckets[i];
+      if (seen > target) {
+        return i == 0 ? 0 : (int64_t(1) << i) - 1;
+      }
+    }
+    return (int64_t(1) << (buckets.size() - 1)) - 1;
+  }
+
+  void reset() {
+    buckets.fill(0);
+    samples = 0;
+  }
+};
+
+// Wire encodings for the grid portion of a state packet. Value 0 was the
+// raw (uncompressed) keyframe of protocol version 1; clients still decode
+// it but the server no longer produces it
+enum GridEncoding : sf::Uint8 {
+  DeltaFrame = 1,
+  RleKeyframe = 2,
+};
+
 // Server Logic
+//
+// The tick is pipelined across two threads. The game thread runs the game
+// logic and serializes the state packets; the I/O thread owns the client
+// sockets and does all the sending and receiving. They exchange work through
+// two single-slot handoffs (state packets one way, collected inputs the
+// other), so while the game thread sleeps toward the next tick deadline the
+// I/O thread is already broadcasting the new state and collecting the
+// replies, instead of all phases running back to back under one mutex.
 class GameServer {
   sf::TcpListener listener;
   std::map<Id, std::shared_ptr<sf::TcpSocket>> clientSockets;
-  std::mutex serverMutex;
+  // Mirror of clientSockets.size(). The main thread's wait loops poll the
+  // client count while the accept thread is still registering clients, so
+  // the count lives in an atomic instead of reading the map cross-thread
+  std::atomic<int> clientCount{0};
   std::shared_ptr<Game> game;
   const Configuration conf;
-  bool running;
+  std::atomic<bool> running;
 
 public:
-  GameServer(std::shared_ptr<Game> game, Configuration conf)
+  // openListener is false for tournament matches: the tournament server
+  // owns the one listener and hands accepted clients over via adoptClient
+  GameServer(std::shared_ptr<Game> game, Configuration conf,
+             bool openListener = true)
       : game(game), conf(conf), running(false) {
+    if (!conf.replayFile.empty()) {
+      replay = std::make_unique<ReplayRecorder>(conf.replayFile, conf);
+    }
+    if (!openListener) {
+      return;
+    }
     const char *portenv = std::getenv("CYCLES_PORT");
     if (portenv == nullptr) {
       spdlog::critical("Please set the CYCLES_PORT environment variable");
@@ -41,19 +109,68 @@ public:
 
   void run() {
     running = true;
+    std::thread commThread(&GameServer::commLoop, this);
     std::thread gameLoopThread(&GameServer::gameLoop, this);
     gameLoopThread.join();
+    running = false;
+    handoffReady.notify_all();
+    commThread.join();
   }
 
-  void stop() { running = false; }
+  void stop() {
+    running = false;
+    handoffReady.notify_all();
+  }
 
   int getFrame() const { return frame; }
 
+  size_t getClientCount() const { return clientCount; }
+
+  bool isFull() const { return clientCount >= conf.maxClients; }
+
   void setAcceptingClients(bool accepting) { acceptingClients = accepting; }
 
+  // Register a client whose handshake has already been read from the
+  // socket. Called from acceptClients in single-match mode and from the
+  // tournament server, which owns the listener and routes clients here by
+  // the match id in their handshake.
+  void adoptClient(std::shared_ptr<sf::TcpSocket> clientSocket,
+                   const std::string &playerName) {
+    auto id = game->addPlayer(playerName);
+    if (replay) {
+      replay->recordJoin(frame, game->getPlayer(id));
+    }
+    // Send color to the client
+    sf::Packet colorPacket;
+    const auto &player = game->getPlayer(id);
+    // The trailing id lets the client look itself up without scanning the
+    // player list; clients built against older headers ignore it
+    colorPacket << player.color.r << player.color.g << player.color.b
+                << player.id;
+    if (clientSocket->send(colorPacket) != sf::Socket::Done) {
+      spdlog::critical("Failed to send color to client: {}", playerName);
+    } else {
+      spdlog::info("Color sent to client: {}", playerName);
+    }
+    clientSocket->setBlocking(
+        false); // Set back to non-blocking for game loop
+    clientSockets[id] = clientSocket;
+    ++clientCount;
+    game->publishSnapshot(); // keep the splash screen current
+    // New clients need a full-grid keyframe before they can apply deltas
+    clientsNeedingKeyframe.insert(id);
+    spdlog::info("New client connected: {} with id {}", playerName, id);
+  }
+
   void acceptClients() {
-    while (acceptingClients &&
-           static_cast<int>(clientSockets.size()) < conf.maxClients) {
+    // Block on the listener instead of spinning on a non-blocking accept;
+    // the short wait keeps the stop flag responsive
+    sf::SocketSelector listenerSelector;
+    listenerSelector.add(listener);
+    while (acceptingClients && !isFull()) {
+      if (!listenerSelector.wait(sf::milliseconds(100))) {
+        continue;
+      }
       auto clientSocket = std::make_shared<sf::TcpSocket>();
       if (listener.accept(*clientSocket) == sf::Socket::Done) {
         clientSocket->setBlocking(
@@ -63,175 +180,623 @@ public:
         if (clientSocket->receive(namePacket) == sf::Socket::Done) {
           std::string playerName;
           namePacket >> playerName;
-          auto id = game->addPlayer(playerName);
-          // Send color to the client
-          sf::Packet colorPacket;
-          const auto &player = game->getPlayers().at(id);
-          colorPacket << player.color.r << player.color.g << player.color.b;
-          if (clientSocket->send(colorPacket) != sf::Socket::Done) {
-            spdlog::critical("Failed to send color to client: {}", playerName);
-          } else {
-            spdlog::info("Color sent to client: {}", playerName);
+          // Clients older than protocol version 2 send only their name;
+          // the trailing match id only matters to the tournament server
+          sf::Uint8 protocolVersion = 1;
+          if (!namePacket.endOfPacket()) {
+            namePacket >> protocolVersion;
           }
-          clientSocket->setBlocking(
-              false); // Set back to non-blocking for game loop
-          clientSockets[id] = clientSocket;
-          spdlog::info("New client connected: {} with id {}", playerName, id);
+          if (protocolVersion < 2) {
+            spdlog::warn("Client {} speaks protocol version {} but the "
+                         "server requires 2, disconnecting",
+                         playerName, protocolVersion);
+            continue;
+          }
+          adoptClient(clientSocket, playerName);
         }
       }
     }
   }
 
 private:
-  int frame = 0;
+  int frame = 0; // owned by the game thread
   const int max_client_communication_time = 50; // ms
 
   bool acceptingClients = true;
 
-  void checkPlayers() {
-    // Remove sockets from players that have died or disconnected
-    spdlog::debug("Server ({}): Checking players", frame);
-    auto players = game->getPlayers();
-    for (const auto &[id, socket] : clientSockets) {
-      bool remove = false;
-      if (players.find(id) == players.end()) {
-        spdlog::info("Player {} has died", id);
-        remove = true;
-      }
-      if (socket->getRemoteAddress() == sf::IpAddress::None) {
-        spdlog::info("Player {} has disconnected", id);
-        remove = true;
-      }
-      if (remove) {
-        game->removePlayer(id);
-        clientSockets.erase(id);
+  // Owned by the I/O thread once run() starts
+  std::set<Id> clientsNeedingKeyframe;
+
+  // Clients whose send/receive returned sf::Socket::Disconnected this
+  // frame; swept (and cleared) at the start of the next frame
+  std::set<Id> disconnectedClients;
+
+  std::unique_ptr<ReplayRecorder> replay;
+
+  // Work the game thread hands to the I/O thread: the serialized state
+  // packets for one frame, plus the players the game logic removed this
+  // frame (their sockets can be dropped)
+  struct TickOutput {
+    int frame = 0;
+    sf::Packet keyframePacket;
+    sf::Packet deltaPacket;
+    std::vector<Id> deadPlayers;
+  };
+
+  // Work the I/O thread hands back: the inputs that arrived in time, the
+  // clients that disconnected or timed out (to be removed from the game),
+  // whether the next frame needs a keyframe, and the comm timings for the
+  // stats histograms
+  struct TickInput {
+    std::map<Id, Direction> directions;
+    std::vector<Id> removedClients;
+    bool keyframeWanted = false;
+    int64_t checkMicros = 0;
+    int64_t sendMicros = 0;
+    int64_t receiveMicros = 0;
+  };
+
+  // Single-slot lock-free handoffs: the producer fills one of its two
+  // buffers and swaps the pointer in, the consumer swaps it out. Strict
+  // alternation (each side waits for the other's slot before reusing a
+  // buffer) means a buffer is never written while the other thread reads
+  // it. The condition variable is only used to nap between polls; the
+  // mutex guards no data.
+  TickOutput outputSlots[2];
+  TickInput inputSlots[2];
+  std::atomic<TickOutput *> publishedOutput{nullptr};
+  std::atomic<TickInput *> publishedInput{nullptr};
+  std::mutex handoffMutex;
+  std::condition_variable handoffReady;
+
+  template <typename Slot> void publishSlot(std::atomic<Slot *> &slot, Slot *value) {
+    slot.store(value, std::memory_order_release);
+    handoffReady.notify_all();
+  }
+
+  // Blocks until the slot holds a value or the server stops (then nullptr)
+  template <typename Slot> Slot *waitForSlot(std::atomic<Slot *> &slot) {
+    std::unique_lock lock(handoffMutex);
+    while (running) {
+      if (auto *value = slot.exchange(nullptr, std::memory_order_acquire)) {
+        return value;
       }
+      handoffReady.wait_for(lock, std::chrono::milliseconds(1));
     }
+    return slot.exchange(nullptr, std::memory_order_acquire);
+  }
+
+  // Per-phase latency histograms, reported every statsReportInterval frames
+  static constexpr int statsReportInterval = 300;
+  struct {
+    LatencyHistogram checkPlayers;
+    LatencyHistogram sendGameState;
+    LatencyHistogram receiveClientInput;
+    LatencyHistogram movePlayers;
+    LatencyHistogram totalTick;
+  } stats;
+
+  void reportStats() {
+    auto line = [](const LatencyHistogram &h) {
+      return fmt::format("p50={}us p95={}us p99={}us", h.percentile(0.50),
+                         h.percentile(0.95), h.percentile(0.99));
+    };
+    spdlog::info("Server stats ({} frames): tick {} | checkPlayers {} | "
+                 "sendGameState {} | receiveClientInput {} | movePlayers {}",
+                 stats.totalTick.samples, line(stats.totalTick),
+                 line(stats.checkPlayers), line(stats.sendGameState),
+                 line(stats.receiveClientInput), line(stats.movePlayers));
+    stats.checkPlayers.reset();
+    stats.sendGameState.reset();
+    stats.receiveClientInput.reset();
+    stats.movePlayers.reset();
+    stats.totalTick.reset();
   }
 
-  auto receiveClientInput(auto clientSockets) {
-    spdlog::debug("Server ({}): Receiving client input from {} clients", frame,
+  auto receiveClientInput(auto clientSockets, int frame) {
+    SPDLOG_DEBUG("Server ({}): Receiving client input from {} clients", frame,
                   clientSockets.size());
     if (clientSockets.size() == 0) {
       return std::map<Id, Direction>();
     }
     std::map<Id, Direction> successful;
     for (const auto &[id, clientSocket] : clientSockets) {
-      auto name = game->getPlayers().at(id).name;
-      spdlog::debug("Server ({}): Receiving input from player {} ({})", frame,
-                    id, name);
+      SPDLOG_DEBUG("Server ({}): Receiving input from player {}", frame, id);
       sf::Packet packet;
       auto status = clientSocket->receive(packet);
       if (status == sf::Socket::Done) {
         int direction;
         packet >> direction;
-        spdlog::debug("Received direction {} from player {} ({})", direction,
-                      id, name);
+        SPDLOG_DEBUG("Received direction {} from player {}", direction, id);
         successful[id] = static_cast<Direction>(direction);
+      } else if (status == sf::Socket::Disconnected) {
+        disconnectedClients.insert(id);
       }
     }
     return successful;
   }
 
-  auto sendGameState(auto clientSockets) {
-    spdlog::debug("Server ({}): Sending game state to {} clients", frame,
-                  clientSockets.size());
-    if (clientSockets.size() == 0) {
-      return std::vector<Id>();
-    }
-    sf::Packet packet;
+  // Build the state packet for the current frame. A keyframe carries the
+  // full grid (raw or run-length encoded depending on the client's protocol
+  // version); a delta carries only the (index, Id) pairs of the cells that
+  // changed since the previous frame.
+  void buildStatePacket(sf::Packet &packet, GridEncoding encoding) {
+    packet.clear();
     packet << conf.gridWidth << conf.gridHeight;
-    const auto &grid = game->getGrid();
-    auto players = game->getPlayers();
+    const auto &players = game->getPlayers();
     packet << static_cast<sf::Uint32>(players.size());
-    for (const auto &[id, player] : players) {
+    for (const auto &player : players) {
       packet << player.position.x << player.position.y << player.color.r
-             << player.color.g << player.color.b << player.name << id << frame;
+             << player.color.g << player.color.b << player.name << player.id
+             << frame;
+    }
+    packet << static_cast<sf::Uint8>(encoding);
+    switch (encoding) {
+    case RleKeyframe: {
+      // (count, Id) runs covering the grid; the board is mostly empty
+      // early-game and long same-Id runs late-game, so this is 10-50x
+      // smaller than the raw grid
+      const auto &grid = game->getGrid();
+      size_t pos = 0;
+      while (pos < grid.size()) {
+        const Id value = grid[pos];
+        size_t runEnd = pos + 1;
+        while (runEnd < grid.size() && grid[runEnd] == value &&
+               runEnd - pos < 0xFFFF) {
+          runEnd++;
+        }
+        packet << static_cast<sf::Uint16>(runEnd - pos) << value;
+        pos = runEnd;
+      }
+      break;
+    }
+    case DeltaFrame: {
+      const auto &changes = game->getChangedCells();
+      packet << static_cast<sf::Uint32>(changes.size());
+      for (const auto &[index, id] : changes) {
+        packet << static_cast<sf::Uint32>(index) << id;
+      }
+      break;
     }
-    for (auto &cell : grid) {
-      packet << cell;
+    }
+  }
+
+  auto sendGameState(auto clientSockets, TickOutput &out) {
+    [[maybe_unused]] const int frame = out.frame;
+    SPDLOG_DEBUG("Server ({}): Sending game state to {} clients", frame,
+                  clientSockets.size());
+    if (clientSockets.size() == 0) {
+      return std::vector<Id>();
     }
     std::vector<Id> successful;
     for (const auto &[id, clientSocket] : clientSockets) {
-      if (clientSocket->send(packet) != sf::Socket::Done) {
-        spdlog::debug("Server ({}): Failed to send game state to player {}",
+      auto &packet = clientsNeedingKeyframe.contains(id) ? out.keyframePacket
+                                                         : out.deltaPacket;
+      const auto status = clientSocket->send(packet);
+      if (status != sf::Socket::Done) {
+        if (status == sf::Socket::Disconnected) {
+          disconnectedClients.insert(id);
+        }
+        SPDLOG_DEBUG("Server ({}): Failed to send game state to player {}",
                       frame, id);
       } else {
         successful.push_back(id);
-        spdlog::debug("Server ({}): Game state sent to player {}", frame, id);
+        clientsNeedingKeyframe.erase(id);
+        SPDLOG_DEBUG("Server ({}): Game state sent to player {}", frame, id);
       }
     }
     return successful;
   }
 
+  static int64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  }
+
+  // Serialize the current frame into the given output slot and hand it to
+  // the I/O thread. A keyframe is only needed for clients that just joined,
+  // so it is built on demand.
+  void publishFrame(TickOutput &out, bool buildKeyframe) {
+    out.frame = frame;
+    game->setFrame(frame);
+    buildStatePacket(out.deltaPacket, DeltaFrame);
+    if (buildKeyframe) {
+      buildStatePacket(out.keyframePacket, RleKeyframe);
+    }
+    game->clearChangedCells();
+    game->publishSnapshot();
+    publishSlot(publishedOutput, &out);
+  }
+
   void gameLoop() {
-    sf::Clock clock;
-    sf::Clock clientCommunicationClock;
+    using steady_clock = std::chrono::steady_clock;
+    const auto tickDuration =
+        std::chrono::microseconds(1000000 / conf.tickRate);
+    auto nextTick = steady_clock::now() + tickDuration;
+    // Frame 0: every connected client still needs a keyframe
+    outputSlots[0].deadPlayers.clear();
+    publishFrame(outputSlots[0], true);
     while (running && !game->isGameOver()) {
-      if (clock.getElapsedTime().asMilliseconds() >= 33) { // ~30 fps
-        clock.restart();
-        std::scoped_lock lock(serverMutex);
-        game->setFrame(frame);
-        checkPlayers();
-        auto clientsUnsent = clientSockets;
-        decltype(clientSockets) toRecieve;
-        std::map<Id, Direction> newDirs;
-        std::set<Id> timedOutPlayers;
-        clientCommunicationClock.restart();
-        while (clientsUnsent.size() > 0 || toRecieve.size() > 0) {
-          auto successful = sendGameState(clientsUnsent);
-          for (auto s : successful) {
-            clientsUnsent.erase(s);
-            toRecieve[s] = clientSockets[s];
+      // The I/O thread is broadcasting the published frame and collecting
+      // the replies while we wait; inputs arrive as soon as every client
+      // has answered or the communication deadline passes
+      TickInput *in = waitForSlot(publishedInput);
+      if (in == nullptr) {
+        break;
+      }
+      if (!conf.fastForward) {
+        // Sleep until the tick deadline instead of burning a core polling
+        // the clock; absolute deadlines keep the schedule drift-free. In
+        // fast-forward mode there is no pacing: having the inputs is the
+        // only gate, so the game runs as fast as the clients can answer.
+        std::this_thread::sleep_until(nextTick);
+        nextTick += tickDuration;
+        if (steady_clock::now() > nextTick) {
+          // More than a full tick behind: resynchronize rather than bursting
+          nextTick = steady_clock::now() + tickDuration;
+        }
+      }
+      const auto tickStart = steady_clock::now();
+      game->setFrame(frame);
+      for (auto id : in->removedClients) {
+        game->removePlayer(id);
+        if (replay) {
+          replay->recordLeave(frame, id);
+        }
+      }
+      if (replay) {
+        replay->recordTick(frame, in->directions);
+      }
+      auto phaseStart = steady_clock::now();
+      game->movePlayers(in->directions);
+      stats.movePlayers.record(microsSince(phaseStart));
+      stats.checkPlayers.record(in->checkMicros);
+      stats.sendGameState.record(in->sendMicros);
+      stats.receiveClientInput.record(in->receiveMicros);
+      frame++;
+      TickOutput &out = outputSlots[frame % 2];
+      // Players that proposed a move and are gone now died in the game
+      // logic this frame; tell the I/O thread to drop their sockets
+      out.deadPlayers.clear();
+      for (const auto &[id, direction] : in->directions) {
+        if (!game->hasPlayer(id)) {
+          spdlog::info("Player {} has died", id);
+          out.deadPlayers.push_back(id);
+        }
+      }
+      publishFrame(out, in->keyframeWanted);
+      stats.totalTick.record(microsSince(tickStart));
+      if (frame % statsReportInterval == 0) {
+        reportStats();
+      }
+    }
+    running = false;
+    handoffReady.notify_all();
+  }
+
+  // I/O thread: owns the client sockets. For each frame published by the
+  // game thread: drop the sockets of players that died, detect
+  // disconnections, broadcast the state and collect the replies until every
+  // client answered or the communication deadline passes, then hand the
+  // inputs back.
+  void commLoop() {
+    sf::Clock clientCommunicationClock;
+    while (true) {
+      TickOutput *out = waitForSlot(publishedOutput);
+      if (out == nullptr) {
+        break;
+      }
+      const int frame = out->frame;
+      TickInput &in = inputSlots[frame % 2];
+      in.directions.clear();
+      in.removedClients.clear();
+      in.checkMicros = in.sendMicros = in.receiveMicros = 0;
+      auto phaseStart = std::chrono::steady_clock::now();
+      for (auto id : out->deadPlayers) {
+        clientSockets.erase(id);
+        clientsNeedingKeyframe.erase(id);
+      }
+      // Disconnects are flagged by the Disconnected statuses the regular
+      // send/receive calls already return, so this is a flag sweep with no
+      // extra syscalls (getpeername polling used to cost one per client per
+      // tick)
+      for (auto id : disconnectedClients) {
+        if (clientSockets.count(id) > 0) {
+          spdlog::info("Player {} has disconnected", id);
+          in.removedClients.push_back(id);
+        }
+      }
+      disconnectedClients.clear();
+      for (auto id : in.removedClients) {
+        if (clientSockets.erase(id)) {
+          --clientCount;
+        }
+        clientsNeedingKeyframe.erase(id);
+      }
+      in.checkMicros = microsSince(phaseStart);
+      auto clientsUnsent = clientSockets;
+      decltype(clientSockets) toRecieve;
+      std::set<Id> timedOutPlayers;
+      clientCommunicationClock.restart();
+      sf::SocketSelector selector;
+      while (clientsUnsent.size() > 0 || toRecieve.size() > 0) {
+        phaseStart = std::chrono::steady_clock::now();
+        auto successful = sendGameState(clientsUnsent, *out);
+        in.sendMicros += microsSince(phaseStart);
+        for (auto s : successful) {
+          clientsUnsent.erase(s);
+          toRecieve[s] = clientSockets[s];
+          selector.add(*clientSockets[s]);
+        }
+        // A send that reported Disconnected will never succeed; stop
+        // retrying it instead of keeping the loop alive until the deadline
+        std::erase_if(clientsUnsent, [&](const auto &entry) {
+          return disconnectedClients.contains(entry.first);
+        });
+        // Sleep until at least one client socket has data instead of
+        // busy-polling receive on every socket
+        const auto remaining =
+            max_client_communication_time -
+            clientCommunicationClock.getElapsedTime().asMilliseconds();
+        if (toRecieve.size() > 0 && remaining > 0 &&
+            selector.wait(sf::milliseconds(remaining))) {
+          phaseStart = std::chrono::steady_clock::now();
+          decltype(clientSockets) ready;
+          for (const auto &[id, socket] : toRecieve) {
+            if (selector.isReady(*socket)) {
+              ready[id] = socket;
+            }
           }
-          auto succesfulrec = receiveClientInput(toRecieve);
+          auto succesfulrec = receiveClientInput(ready, frame);
           for (auto s : succesfulrec) {
+            selector.remove(*toRecieve[s.first]);
             toRecieve.erase(s.first);
-            newDirs[s.first] = s.second;
+            in.directions[s.first] = s.second;
           }
-          spdlog::debug("Server ({}): Clients unsent: {}", frame,
-                        clientsUnsent.size());
-          spdlog::debug("Server ({}): Clients to recieve: {}", frame,
-                        toRecieve.size());
-          // Check for clients that have not sent input for a long time
-          if (clientCommunicationClock.getElapsedTime().asMilliseconds() >
-              max_client_communication_time) {
-            // Mark all remaining clients for removal
-            for (auto [id, socket] : clientsUnsent) {
-              timedOutPlayers.insert(id);
-            }
-            for (auto [id, socket] : toRecieve) {
-              timedOutPlayers.insert(id);
+          // An EOF'd socket stays "ready" forever, so a disconnect left in
+          // the selector would turn the wait into a busy loop for the rest
+          // of the deadline; drop it now rather than at the timeout sweep
+          for (const auto &[id, socket] : ready) {
+            if (disconnectedClients.contains(id) && toRecieve.contains(id)) {
+              selector.remove(*socket);
+              toRecieve.erase(id);
             }
-            break;
           }
+          in.receiveMicros += microsSince(phaseStart);
+        } else if (clientsUnsent.size() > 0) {
+          // Nothing readable yet and some sends still pending: give the
+          // send buffers a moment to drain instead of spinning
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
-        for (auto id : timedOutPlayers) {
-          spdlog::info(
-              "Server ({}): Client {} has not sent input for a long time",
-              frame, id);
-          game->removePlayer(id);
-          clientSockets.erase(id);
-          newDirs.erase(id);
+        SPDLOG_DEBUG("Server ({}): Clients unsent: {}", frame,
+                      clientsUnsent.size());
+        SPDLOG_DEBUG("Server ({}): Clients to recieve: {}", frame,
+                      toRecieve.size());
+        // Check for clients that have not sent input for a long time
+        if (clientCommunicationClock.getElapsedTime().asMilliseconds() >
+            max_client_communication_time) {
+          // Mark all remaining clients for removal
+          for (auto [id, socket] : clientsUnsent) {
+            timedOutPlayers.insert(id);
+          }
+          for (auto [id, socket] : toRecieve) {
+            timedOutPlayers.insert(id);
+          }
+          break;
         }
-        game->movePlayers(newDirs);
-        frame++;
+      }
+      for (auto id : timedOutPlayers) {
+        spdlog::info(
+            "Server ({}): Client {} has not sent input for a long time",
+            frame, id);
+        if (clientSockets.erase(id)) {
+          --clientCount;
+        }
+        clientsNeedingKeyframe.erase(id);
+        in.directions.erase(id);
+        in.removedClients.push_back(id);
+      }
+      in.keyframeWanted = !clientsNeedingKeyframe.empty();
+      publishSlot(publishedInput, &in);
+    }
+  }
+};
+
+// Tournament mode: one process hosts several matches concurrently. A single
+// listener accepts every client and routes it to the match named in its
+// handshake; each match then runs its own pipelined tick engine (game
+// thread plus I/O thread), so concurrent matches spread across all cores
+// without paying process startup, port binding or splash-screen
+// interaction per match.
+class TournamentServer {
+  const Configuration conf;
+  sf::TcpListener listener;
+  std::vector<std::shared_ptr<Game>> games;
+  std::vector<std::unique_ptr<GameServer>> matches;
+  bool acceptingClients = true;
+
+public:
+  TournamentServer(Configuration conf, int matchCount) : conf(conf) {
+    for (int i = 0; i < matchCount; ++i) {
+      auto matchConf = conf;
+      if (!matchConf.replayFile.empty()) {
+        // One replay file per match
+        matchConf.replayFile += ".match" + std::to_string(i);
+      }
+      games.push_back(std::make_shared<Game>(matchConf));
+      matches.push_back(
+          std::make_unique<GameServer>(games.back(), matchConf, false));
+    }
+    const char *portenv = std::getenv("CYCLES_PORT");
+    if (portenv == nullptr) {
+      spdlog::critical("Please set the CYCLES_PORT environment variable");
+      exit(1);
+    }
+    spdlog::info("Tournament: hosting {} matches on port {}", matchCount,
+                 portenv);
+    const unsigned short PORT = std::stoi(portenv);
+    listener.listen(PORT);
+    listener.setBlocking(false);
+    if (listener.getLocalPort() == 0) {
+      spdlog::critical("Failed to bind to port {}", PORT);
+      exit(1);
+    }
+  }
+
+  void setAcceptingClients(bool accepting) { acceptingClients = accepting; }
+
+  bool allMatchesFull() const {
+    for (const auto &match : matches) {
+      if (!match->isFull()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void acceptClients() {
+    sf::SocketSelector listenerSelector;
+    listenerSelector.add(listener);
+    while (acceptingClients && !allMatchesFull()) {
+      if (!listenerSelector.wait(sf::milliseconds(100))) {
+        continue;
+      }
+      auto clientSocket = std::make_shared<sf::TcpSocket>();
+      if (listener.accept(*clientSocket) != sf::Socket::Done) {
+        continue;
+      }
+      clientSocket->setBlocking(true);
+      sf::Packet namePacket;
+      if (clientSocket->receive(namePacket) != sf::Socket::Done) {
+        continue;
+      }
+      std::string playerName;
+      namePacket >> playerName;
+      sf::Uint8 protocolVersion = 1;
+      sf::Uint16 matchId = 0;
+      if (!namePacket.endOfPacket()) {
+        namePacket >> protocolVersion;
+      }
+      if (!namePacket.endOfPacket()) {
+        namePacket >> matchId;
+      }
+      if (protocolVersion < 2) {
+        spdlog::warn("Client {} speaks protocol version {} but the server "
+                     "requires 2, disconnecting",
+                     playerName, protocolVersion);
+        continue;
+      }
+      if (matchId >= matches.size()) {
+        spdlog::warn("Client {} asked for match {} but only {} exist, "
+                     "disconnecting",
+                     playerName, matchId, matches.size());
+        continue;
+      }
+      if (matches[matchId]->isFull()) {
+        spdlog::warn("Client {} asked for match {} which is full, "
+                     "disconnecting",
+                     playerName, matchId);
+        continue;
+      }
+      spdlog::info("Routing client {} to match {}", playerName, matchId);
+      matches[matchId]->adoptClient(clientSocket, playerName);
+    }
+  }
+
+  // Run every non-empty match to completion and report the winners
+  void run() {
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < matches.size(); ++i) {
+      if (matches[i]->getClientCount() == 0) {
+        spdlog::warn("Match {} has no clients, skipping", i);
+        continue;
+      }
+      workers.emplace_back(&GameServer::run, matches[i].get());
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (size_t i = 0; i < games.size(); ++i) {
+      const auto &players = games[i]->getPlayers();
+      if (players.size() == 1) {
+        spdlog::info("Match {}: winner is {}", i, players.front().name);
+      } else {
+        spdlog::info("Match {}: no winner ({} players left)", i,
+                     players.size());
       }
     }
   }
 };
 
 int main(int argc, char *argv[]) {
+  // Route logging through an asynchronous ring buffer: the game and I/O
+  // threads only enqueue messages, a background thread does the terminal
+  // I/O, and on overrun the oldest messages are dropped — so a slow
+  // terminal can never stall the tick
+  spdlog::init_thread_pool(8192, 1);
+  spdlog::set_default_logger(
+      spdlog::create_async_nb<spdlog::sinks::stdout_color_sink_mt>("server"));
 #if SPDLOG_ACTIVE_LEVEL == SPDLOG_LEVEL_TRACE
   spdlog::set_level(spdlog::level::debug);
 #endif
   std::srand(static_cast<unsigned int>(std::time(nullptr)));
-  const std::string config_path = argc > 1 ? argv[1] : "config.yaml";
+  std::string config_path = "config.yaml";
+  std::string playbackFile;
+  int tournamentMatches = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string(argv[i]) == "--playback" && i + 1 < argc) {
+      playbackFile = argv[++i];
+    } else if (std::string(argv[i]) == "--tournament" && i + 1 < argc) {
+      tournamentMatches = std::stoi(argv[++i]);
+    } else {
+      config_path = argv[i];
+    }
+  }
   const Configuration conf(config_path);
+  if (tournamentMatches > 0) {
+    // Tournament mode is headless: accept clients for the waiting period
+    // (or until every match is full), then run all matches concurrently
+    TournamentServer tournament(conf, tournamentMatches);
+    std::thread acceptThread(&TournamentServer::acceptClients, &tournament);
+    spdlog::info("Tournament mode: waiting up to {} seconds for clients",
+                 conf.headlessWaitTime);
+    sf::Clock waitClock;
+    while (waitClock.getElapsedTime().asSeconds() < conf.headlessWaitTime &&
+           !tournament.allMatchesFull()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    tournament.setAcceptingClients(false);
+    acceptThread.join();
+    tournament.run();
+    return 0;
+  }
   auto game = std::make_shared<Game>(conf);
+  if (!playbackFile.empty()) {
+    // Re-run a recorded game without sockets or a window, e.g. to reproduce
+    // a bug or profile the game logic in isolation
+    return playReplay(playbackFile, conf, *game) ? 0 : 1;
+  }
   GameServer server(game, conf);
-  GameRenderer renderer(conf);
   std::thread acceptThread(&GameServer::acceptClients, &server);
+  if (conf.headless) {
+    // Dedicated-server mode: no window, no render loop. Start once all the
+    // slots are filled or the waiting period expires.
+    spdlog::info("Headless mode: waiting up to {} seconds for clients",
+                 conf.headlessWaitTime);
+    sf::Clock waitClock;
+    while (waitClock.getElapsedTime().asSeconds() < conf.headlessWaitTime &&
+           static_cast<int>(server.getClientCount()) < conf.maxClients) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    server.setAcceptingClients(false);
+    acceptThread.join();
+    spdlog::info("Headless mode: starting game with {} clients",
+                 server.getClientCount());
+    server.run();
+    return 0;
+  }
+  GameRenderer renderer(conf);
   bool acceptingClients = true;
   auto spaceEvent = [&acceptingClients](auto &event) {
     if (event.type == sf::Event::KeyPressed &&
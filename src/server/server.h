@@ -1,15 +1,88 @@
 #pragma once
 #include "api.h"
 #include <SFML/Main.hpp>
-#include <list>
+#include <vector>
 
 namespace cycles_server {
 using cycles::Direction;
 using cycles::Id;
 
+/**
+ * A player's tail stored as a contiguous ring buffer, newest cell first
+ * (same ordering as the std::list push_front it replaces). Capacity grows
+ * geometrically, so the per-frame push_front/pop_back in movePlayers
+ * allocates nothing in steady state and traversal walks contiguous memory.
+ */
+class Tail {
+  std::vector<sf::Vector2i> cells;
+  size_t head = 0; // index of the newest cell
+  size_t count = 0;
+
+public:
+  size_t size() const { return count; }
+
+  bool empty() const { return count == 0; }
+
+  const sf::Vector2i &front() const { return cells[head]; }
+
+  const sf::Vector2i &back() const {
+    return cells[(head + count - 1) % cells.size()];
+  }
+
+  void push_front(sf::Vector2i cell) {
+    if (count == cells.size()) {
+      grow();
+    }
+    head = (head + cells.size() - 1) % cells.size();
+    cells[head] = cell;
+    count++;
+  }
+
+  void pop_back() { count--; }
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+
+  class const_iterator {
+    const Tail *tail;
+    size_t pos;
+
+  public:
+    const_iterator(const Tail *tail, size_t pos) : tail(tail), pos(pos) {}
+    const sf::Vector2i &operator*() const {
+      return tail->cells[(tail->head + pos) % tail->cells.size()];
+    }
+    const_iterator &operator++() {
+      pos++;
+      return *this;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return pos != other.pos;
+    }
+  };
+
+  const_iterator begin() const { return {this, 0}; }
+
+  const_iterator end() const { return {this, count}; }
+
+private:
+  void grow() {
+    std::vector<sf::Vector2i> bigger;
+    bigger.reserve(std::max<size_t>(8, cells.size() * 2));
+    for (const auto &cell : *this) {
+      bigger.push_back(cell);
+    }
+    bigger.resize(bigger.capacity());
+    cells = std::move(bigger);
+    head = 0;
+  }
+};
+
 struct Player {
   sf::Vector2i position;
-  std::list<sf::Vector2i> tail;
+  Tail tail;
   sf::Color color;
   std::string name;
   Id id;
@@ -20,6 +93,11 @@ struct Player {
 struct Configuration {
 
   int maxClients = 60;
+  int tickRate = 30; // game ticks per second
+  // Fast-forward: no wall-clock pacing at all, the frame advances the
+  // moment every live client's input has arrived (for AI training runs,
+  // best combined with headless)
+  bool fastForward = false;
   int gridWidth = 100;
   int gridHeight = 100;
   int gameWidth = 1000;
@@ -27,6 +105,9 @@ struct Configuration {
   int gameBannerHeight = 100;
   float cellSize = 10;
   bool enablePostProcessing = false;
+  bool headless = false;
+  int headlessWaitTime = 10; // seconds to wait for clients before a headless game starts
+  std::string replayFile = ""; // record the game to this file when non-empty
   Configuration(std::string configPath);
 };
 } // namespace cycles_server
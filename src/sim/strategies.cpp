@@ -0,0 +1,141 @@
+#include "strategies.h"
+#include "utils.h"
+#include <spdlog/spdlog.h>
+
+namespace cycles_sim {
+
+using cycles::getDirectionFromValue;
+using cycles::getDirectionVector;
+
+RandomStrategy::RandomStrategy() {
+  std::uniform_int_distribution<int> dist(0, 50);
+  inertia = dist(rng);
+}
+
+Direction RandomStrategy::decideMove(const GameState &state,
+                                     const Player &self) {
+  constexpr int max_attempts = 200;
+  int attempts = 0;
+  float inertialDamping = 1.0;
+  auto dist = std::uniform_int_distribution<int>(
+      0, 3 + static_cast<int>(inertia * inertialDamping));
+  auto is_valid_move = [&](Direction direction) {
+    auto new_pos = self.position + getDirectionVector(direction);
+    return state.isInsideGrid(new_pos) && state.getGridCell(new_pos) == 0;
+  };
+  Direction direction = Direction::north;
+  do {
+    if (attempts >= max_attempts) {
+      // Trapped: make the move anyway and let the game logic remove us
+      spdlog::debug("{}: no valid move after {} attempts", self.name,
+                    max_attempts);
+      return direction;
+    }
+    int proposal = dist(rng);
+    if (proposal > 3) {
+      proposal = previousDirection;
+      inertialDamping = 0; // Remove inertia if the previous direction is not valid
+    }
+    direction = getDirectionFromValue(proposal);
+    attempts++;
+  } while (!is_valid_move(direction));
+  previousDirection = cycles::getDirectionValue(direction);
+  return direction;
+}
+
+bool SquareStrategy::is_valid_move(const GameState &state, const Player &self,
+                                   Direction direction) {
+  auto new_pos = self.position + getDirectionVector(direction);
+  if (!state.isInsideGrid(new_pos)) {
+    return false;
+  }
+  if (state.getGridCell(new_pos) != 0) {
+    return false;
+  }
+  for (const auto &player : state.players) {
+    if (player.id != self.id && player.position == new_pos) {
+      return false;
+    }
+  }
+  // avoid risky moves near grid edges
+  if (new_pos.x < 2 || new_pos.x >= state.gridWidth - 2 || new_pos.y < 2 ||
+      new_pos.y >= state.gridHeight - 2) {
+    return false;
+  }
+  return true;
+}
+
+bool SquareStrategy::is_self_collision(const sf::Vector2i &pos) {
+  return trail.count(pos) > 0;
+}
+
+void SquareStrategy::updateTrail(const sf::Vector2i &newPos) {
+  trail.insert(newPos);
+  trailQueue.push(newPos);
+  if (trailQueue.size() > static_cast<size_t>(MAX_TRAIL_LENGTH)) {
+    auto oldPos = trailQueue.front();
+    trail.erase(oldPos);
+    trailQueue.pop();
+  }
+}
+
+Direction SquareStrategy::decideMove(const GameState &state,
+                                     const Player &self) {
+  // prioritize inward movement near edges
+  int dangerZone = 2;
+  bool nearLeft = self.position.x < dangerZone;
+  bool nearRight = self.position.x >= state.gridWidth - dangerZone;
+  bool nearTop = self.position.y < dangerZone;
+  bool nearBottom = self.position.y >= state.gridHeight - dangerZone;
+  if (nearLeft || nearRight || nearTop || nearBottom) {
+    if (nearRight && is_valid_move(state, self, Direction::west))
+      return Direction::west;
+    if (nearLeft && is_valid_move(state, self, Direction::east))
+      return Direction::east;
+    if (nearTop && is_valid_move(state, self, Direction::south))
+      return Direction::south;
+    if (nearBottom && is_valid_move(state, self, Direction::north))
+      return Direction::north;
+  }
+
+  // follow square-pattern logic
+  if (stepsOnCurrentSide >= squareSize) {
+    switch (currentDirection) {
+    case Direction::north: currentDirection = Direction::east; break;
+    case Direction::east: currentDirection = Direction::south; break;
+    case Direction::south: currentDirection = Direction::west; break;
+    case Direction::west: currentDirection = Direction::north; break;
+    }
+    stepsOnCurrentSide = 0;
+    sidesCompleted++;
+    if (sidesCompleted == 4) {
+      squareSize++;
+      sidesCompleted = 0;
+    }
+  }
+
+  sf::Vector2i nextPos = self.position + getDirectionVector(currentDirection);
+  if (is_valid_move(state, self, currentDirection) &&
+      !is_self_collision(nextPos)) {
+    stepsOnCurrentSide++;
+    updateTrail(nextPos);
+    return currentDirection;
+  }
+
+  // fallback to valid directions
+  for (int i = 0; i < 4; ++i) {
+    auto direction = getDirectionFromValue(i);
+    sf::Vector2i fallbackPos = self.position + getDirectionVector(direction);
+    if (is_valid_move(state, self, direction) &&
+        !is_self_collision(fallbackPos)) {
+      updateTrail(fallbackPos);
+      return direction;
+    }
+  }
+
+  // Trapped: make the move anyway and let the game logic remove us
+  spdlog::debug("{}: no valid moves available", self.name);
+  return currentDirection;
+}
+
+} // namespace cycles_sim
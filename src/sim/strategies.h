@@ -0,0 +1,74 @@
+#pragma once
+#include "api.h"
+#include <memory>
+#include <queue>
+#include <random>
+#include <set>
+
+namespace cycles_sim {
+using cycles::Direction;
+using cycles::GameState;
+using cycles::Player;
+
+/**
+ * @brief A bot's decision logic, decoupled from the transport
+ *
+ * The networked clients (src/client) and the in-process simulation harness
+ * both drive strategies through this interface: once per frame the strategy
+ * sees the current state and its own player and returns a move. Strategies
+ * are stateful (trails, rng, pattern counters); use one instance per bot.
+ * A strategy with no legal move should return any direction and let the
+ * game logic remove the bot, not terminate the process.
+ */
+class BotStrategy {
+public:
+  virtual ~BotStrategy() = default;
+
+  virtual Direction decideMove(const GameState &state, const Player &self) = 0;
+};
+
+/**
+ * @brief Random walk with inertia, ported from client_randomio.cpp
+ */
+class RandomStrategy : public BotStrategy {
+  std::mt19937 rng{std::random_device{}()};
+  int previousDirection = -1;
+  int inertia;
+
+public:
+  RandomStrategy();
+
+  Direction decideMove(const GameState &state, const Player &self) override;
+};
+
+/**
+ * @brief Growing-square pattern with a recent-trail memory, ported from
+ * client_laura.cpp
+ */
+class SquareStrategy : public BotStrategy {
+  struct VectorComparator {
+    bool operator()(const sf::Vector2i &lhs, const sf::Vector2i &rhs) const {
+      return (lhs.x < rhs.x) || (lhs.x == rhs.x && lhs.y < rhs.y);
+    }
+  };
+
+  Direction currentDirection = Direction::north;
+  std::set<sf::Vector2i, VectorComparator> trail;
+  std::queue<sf::Vector2i> trailQueue;
+  const int MAX_TRAIL_LENGTH = 200;
+  int squareSize = 1;
+  int stepsOnCurrentSide = 0;
+  int sidesCompleted = 0;
+
+  bool is_valid_move(const GameState &state, const Player &self,
+                     Direction direction);
+
+  bool is_self_collision(const sf::Vector2i &pos);
+
+  void updateTrail(const sf::Vector2i &newPos);
+
+public:
+  Direction decideMove(const GameState &state, const Player &self) override;
+};
+
+} // namespace cycles_sim
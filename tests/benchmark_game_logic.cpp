@@ -0,0 +1,296 @@
+// Microbenchmarks for the game logic and serialization hot paths.
+// Not run by ctest: build the `benchmarks` target and run it directly to get
+// per-iteration wall time and allocation counts before/after a change.
+#include "server/game_logic.h"
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using cycles::Direction;
+using cycles::Id;
+using namespace cycles_server;
+
+// Global allocation counter so each benchmark can report how many heap
+// allocations a single iteration performs
+static std::atomic<size_t> allocationCount{0};
+
+void *operator new(size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+std::string writeConfig(int gridWidth, int gridHeight, int maxClients) {
+  std::string conf_yaml = "gameHeight: 1000\n"
+                          "gameWidth: 1000\n"
+                          "gameBannerHeight: 100\n"
+                          "gridHeight: " +
+                          std::to_string(gridHeight) +
+                          "\ngridWidth: " + std::to_string(gridWidth) +
+                          "\nmaxClients: " + std::to_string(maxClients) + "\n";
+  auto temp_file = std::tmpnam(nullptr);
+  std::ofstream out(temp_file);
+  out << conf_yaml;
+  return temp_file;
+}
+
+struct BenchResult {
+  double microsPerIteration;
+  double allocationsPerIteration;
+};
+
+// Runs fn() `iterations` times and reports mean wall time and allocations
+template <typename F> BenchResult bench(int iterations, F &&fn) {
+  allocationCount = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    fn();
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const double micros =
+      std::chrono::duration<double, std::micro>(stop - start).count();
+  return {micros / iterations,
+          static_cast<double>(allocationCount.load()) / iterations};
+}
+
+void report(const std::string &name, int playerCount, int gridSize,
+            const BenchResult &result) {
+  std::printf("%-28s players=%-4d grid=%-5d %10.2f us/iter %10.1f allocs/iter\n",
+              name.c_str(), playerCount, gridSize, result.microsPerIteration,
+              result.allocationsPerIteration);
+}
+
+// Picks an in-bounds direction for every live player, favoring empty cells,
+// roughly what a simple bot would send
+std::map<Id, Direction> scriptedDirections(Game &game, const Configuration &conf,
+                                           std::mt19937 &rng) {
+  std::map<Id, Direction> directions;
+  std::uniform_int_distribution<int> dist(0, 3);
+  const auto &grid = game.getGrid();
+  for (const auto &player : game.getPlayers()) {
+    Direction choice = cycles::getDirectionFromValue(dist(rng));
+    for (int attempt = 0; attempt < 4; ++attempt) {
+      auto candidate = cycles::getDirectionFromValue((dist(rng) + attempt) % 4);
+      auto pos = player.position + getDirectionVector(candidate);
+      if (pos.x < 0 || pos.x >= conf.gridWidth || pos.y < 0 ||
+          pos.y >= conf.gridHeight) {
+        continue;
+      }
+      if (grid[pos.y * conf.gridWidth + pos.x] == 0) {
+        choice = candidate;
+        break;
+      }
+    }
+    directions[player.id] = choice;
+  }
+  return directions;
+}
+
+void benchMovePlayers(int playerCount, int gridSize) {
+  Configuration conf(writeConfig(gridSize, gridSize, playerCount));
+  Game game(conf);
+  for (int i = 0; i < playerCount; ++i) {
+    game.addPlayer("bot" + std::to_string(i));
+  }
+  std::mt19937 rng(1234);
+  int frame = 0;
+  auto result = bench(300, [&] {
+    game.setFrame(frame++);
+    auto directions = scriptedDirections(game, conf, rng);
+    game.movePlayers(directions);
+    game.clearChangedCells();
+  });
+  report("movePlayers", playerCount, gridSize, result);
+}
+
+void benchAddPlayer(int playerCount, int gridSize) {
+  // Measures placement retries on an increasingly crowded grid
+  Configuration conf(writeConfig(gridSize, gridSize, playerCount));
+  Game game(conf);
+  std::mt19937 rng(1234);
+  // Crowd the grid with tails before timing the joins
+  for (int i = 0; i < playerCount / 2; ++i) {
+    game.addPlayer("resident" + std::to_string(i));
+  }
+  for (int frame = 0; frame < 200; ++frame) {
+    game.setFrame(frame);
+    auto directions = scriptedDirections(game, conf, rng);
+    game.movePlayers(directions);
+    game.clearChangedCells();
+  }
+  int joiner = 0;
+  auto result = bench(playerCount / 2, [&] {
+    game.addPlayer("latejoin" + std::to_string(joiner++));
+  });
+  report("addPlayer (crowded)", playerCount, gridSize, result);
+}
+
+void benchSerialization(int playerCount, int gridSize) {
+  Configuration conf(writeConfig(gridSize, gridSize, playerCount));
+  Game game(conf);
+  std::mt19937 rng(1234);
+  for (int i = 0; i < playerCount; ++i) {
+    game.addPlayer("bot" + std::to_string(i));
+  }
+  for (int frame = 0; frame < 100; ++frame) {
+    game.setFrame(frame);
+    auto directions = scriptedDirections(game, conf, rng);
+    game.movePlayers(directions);
+    game.clearChangedCells();
+  }
+  // One more frame without clearing, so the delta benchmarks see the
+  // changed-cell set of a representative mid-game tick
+  game.setFrame(100);
+  auto directions = scriptedDirections(game, conf, rng);
+  game.movePlayers(directions);
+  auto encodeHeader = [&](sf::Packet &packet, sf::Uint8 encoding) {
+    packet << conf.gridWidth << conf.gridHeight;
+    const auto &players = game.getPlayers();
+    packet << static_cast<sf::Uint32>(players.size());
+    for (const auto &player : players) {
+      packet << player.position.x << player.position.y << player.color.r
+             << player.color.g << player.color.b << player.name << player.id
+             << 0;
+    }
+    packet << encoding;
+  };
+  // Encode: mirrors the RleKeyframe case of GameServer::buildStatePacket,
+  // (count, Id) runs covering the grid
+  auto encodeRle = [&] {
+    sf::Packet packet;
+    encodeHeader(packet, 2);
+    const auto &grid = game.getGrid();
+    size_t pos = 0;
+    while (pos < grid.size()) {
+      const Id value = grid[pos];
+      size_t runEnd = pos + 1;
+      while (runEnd < grid.size() && grid[runEnd] == value &&
+             runEnd - pos < 0xFFFF) {
+        runEnd++;
+      }
+      packet << static_cast<sf::Uint16>(runEnd - pos) << value;
+      pos = runEnd;
+    }
+    return packet;
+  };
+  report("serialize keyframe (RLE)", playerCount, gridSize,
+         bench(200, encodeRle));
+  // Encode: mirrors the DeltaFrame case, only the cells that changed since
+  // the previous frame
+  auto encodeDelta = [&] {
+    sf::Packet packet;
+    encodeHeader(packet, 1);
+    const auto &changes = game.getChangedCells();
+    packet << static_cast<sf::Uint32>(changes.size());
+    for (const auto &[index, id] : changes) {
+      packet << static_cast<sf::Uint32>(index) << id;
+    }
+    return packet;
+  };
+  report("serialize delta frame", playerCount, gridSize,
+         bench(200, encodeDelta));
+  // Historical comparisons: the raw full-grid keyframe of protocol version
+  // 1 (no longer produced by the server), bulk-appended and << per cell, to
+  // show what RLE buys on the wire and what the bulk append bought per cell
+  auto encodeRaw = [&] {
+    sf::Packet packet;
+    encodeHeader(packet, 0);
+    const auto &grid = game.getGrid();
+    packet.append(grid.data(), grid.size());
+    return packet;
+  };
+  report("serialize keyframe (raw v1)", playerCount, gridSize,
+         bench(200, encodeRaw));
+  auto encodePerCell = [&] {
+    sf::Packet packet;
+    encodeHeader(packet, 0);
+    for (auto &cell : game.getGrid()) {
+      packet << cell;
+    }
+    return packet;
+  };
+  report("serialize keyframe (percell)", playerCount, gridSize,
+         bench(200, encodePerCell));
+  auto decodeHeader = [](sf::Packet &packet, int &width, int &height) {
+    packet >> width >> height;
+    sf::Uint32 count = 0;
+    packet >> count;
+    for (sf::Uint32 i = 0; i < count; ++i) {
+      int x, y, frame;
+      sf::Uint8 r, g, b;
+      Id id;
+      std::string name;
+      packet >> x >> y >> r >> g >> b >> name >> id >> frame;
+    }
+    sf::Uint8 packetType;
+    packet >> packetType;
+  };
+  // Decode: mirrors the run-length branch of GameState::readFrom
+  auto rleReference = encodeRle();
+  auto rleResult = bench(200, [&] {
+    sf::Packet packet = rleReference;
+    int width, height;
+    decodeHeader(packet, width, height);
+    std::vector<Id> grid(width * height);
+    size_t pos = 0;
+    while (pos < grid.size()) {
+      sf::Uint16 runLength = 0;
+      Id value = 0;
+      if (!(packet >> runLength >> value) || runLength == 0 ||
+          pos + runLength > grid.size()) {
+        break; // a real client treats this as malformed
+      }
+      std::fill_n(grid.begin() + pos, runLength, value);
+      pos += runLength;
+    }
+  });
+  report("deserialize keyframe (RLE)", playerCount, gridSize, rleResult);
+  // Decode: mirrors the delta branch, applied on top of the previous grid
+  auto deltaReference = encodeDelta();
+  std::vector<Id> previousGrid = game.getGrid();
+  auto deltaResult = bench(200, [&] {
+    sf::Packet packet = deltaReference;
+    int width, height;
+    decodeHeader(packet, width, height);
+    sf::Uint32 changeCount = 0;
+    packet >> changeCount;
+    for (sf::Uint32 i = 0; i < changeCount; ++i) {
+      sf::Uint32 index = 0;
+      Id value = 0;
+      if (!(packet >> index >> value) ||
+          index >= previousGrid.size()) {
+        break; // a real client treats this as malformed
+      }
+      previousGrid[index] = value;
+    }
+  });
+  report("deserialize delta frame", playerCount, gridSize, deltaResult);
+}
+
+} // namespace
+
+int main() {
+  for (int gridSize : {100, 200}) {
+    for (int playerCount : {8, 32, 60, 128}) {
+      benchMovePlayers(playerCount, gridSize);
+      benchAddPlayer(playerCount, gridSize);
+      benchSerialization(playerCount, gridSize);
+    }
+  }
+  return 0;
+}
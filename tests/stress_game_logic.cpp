@@ -0,0 +1,208 @@
+// Stress-scale property harness for the game logic.
+// Not run by ctest: build the `stress_game_logic` target and run it directly.
+// Drives a Game instance with N synthetic players following a scripted
+// policy for M frames, re-checking the grid/tail invariants after every
+// movePlayers call and reporting per-frame timing percentiles, e.g.
+//
+//   ./stress_game_logic --players 250 --frames 5000 --grid 1000
+//
+// Dead players are respawned so the load stays at N for the whole run; the
+// run is deterministic for a given seed.
+#include "server/game_logic.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using cycles::Direction;
+using cycles::Id;
+using namespace cycles_server;
+
+namespace {
+
+std::string writeConfig(int gridWidth, int gridHeight, int maxClients) {
+  std::string conf_yaml = "gameHeight: 1000\n"
+                          "gameWidth: 1000\n"
+                          "gameBannerHeight: 100\n"
+                          "gridHeight: " +
+                          std::to_string(gridHeight) +
+                          "\ngridWidth: " + std::to_string(gridWidth) +
+                          "\nmaxClients: " + std::to_string(maxClients) + "\n";
+  auto temp_file = std::tmpnam(nullptr);
+  std::ofstream out(temp_file);
+  out << conf_yaml;
+  return temp_file;
+}
+
+// Rebuilds the grid from the player list and compares it cell by cell, the
+// same invariant test_game_logic.cpp checks on its small scenarios
+bool checkGridInvariant(const std::vector<sf::Uint8> &grid,
+                        const std::vector<Player> &players,
+                        const Configuration &conf, int frame) {
+  static std::vector<sf::Uint8> true_grid;
+  true_grid.assign(conf.gridWidth * conf.gridHeight, 0);
+  for (const auto &player : players) {
+    true_grid[player.position.y * conf.gridWidth + player.position.x] =
+        player.id;
+    for (auto tail : player.tail) {
+      true_grid[tail.y * conf.gridWidth + tail.x] = player.id;
+    }
+  }
+  for (size_t i = 0; i < true_grid.size(); ++i) {
+    if (grid[i] != true_grid[i]) {
+      std::fprintf(stderr,
+                   "invariant violated at frame %d: cell (%zu,%zu) holds %d, "
+                   "players imply %d\n",
+                   frame, i % conf.gridWidth, i / conf.gridWidth, int(grid[i]),
+                   int(true_grid[i]));
+      return false;
+    }
+  }
+  return true;
+}
+
+// Same scripted policy as the benchmarks: a random in-bounds direction,
+// favoring empty cells
+std::map<Id, Direction> scriptedDirections(Game &game, const Configuration &conf,
+                                           std::mt19937 &rng) {
+  std::map<Id, Direction> directions;
+  std::uniform_int_distribution<int> dist(0, 3);
+  const auto &grid = game.getGrid();
+  for (const auto &player : game.getPlayers()) {
+    Direction choice = cycles::getDirectionFromValue(dist(rng));
+    for (int attempt = 0; attempt < 4; ++attempt) {
+      auto candidate = cycles::getDirectionFromValue((dist(rng) + attempt) % 4);
+      auto pos = player.position + getDirectionVector(candidate);
+      if (pos.x < 0 || pos.x >= conf.gridWidth || pos.y < 0 ||
+          pos.y >= conf.gridHeight) {
+        continue;
+      }
+      if (grid[pos.y * conf.gridWidth + pos.x] == 0) {
+        choice = candidate;
+        break;
+      }
+    }
+    directions[player.id] = choice;
+  }
+  return directions;
+}
+
+// Deterministic spawn: rolls positions from the harness rng instead of the
+// game's own (random_device seeded) generator
+Id spawnPlayer(Game &game, const Configuration &conf, std::mt19937 &rng,
+               int serial) {
+  std::uniform_int_distribution<int> xDist(0, conf.gridWidth - 1);
+  std::uniform_int_distribution<int> yDist(0, conf.gridHeight - 1);
+  std::uniform_int_distribution<int> cDist(50, 200);
+  sf::Vector2i position;
+  const auto &grid = game.getGrid();
+  do {
+    position = {xDist(rng), yDist(rng)};
+  } while (grid[position.y * conf.gridWidth + position.x] != 0);
+  return game.addPlayer("synthetic" + std::to_string(serial), position,
+                        sf::Color(cDist(rng), cDist(rng), cDist(rng)));
+}
+
+double percentile(std::vector<double> sorted, double p) {
+  const size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+  return sorted[index];
+}
+
+void usage(const char *argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--players N] [--frames M] [--grid S] [--seed K]\n",
+               argv0);
+  exit(1);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int players = 250;
+  int frames = 2000;
+  int gridSize = 1000;
+  unsigned seed = 1234;
+  for (int i = 1; i < argc; ++i) {
+    auto intArg = [&](int &value) {
+      if (i + 1 >= argc) {
+        usage(argv[0]);
+      }
+      value = std::atoi(argv[++i]);
+    };
+    if (std::strcmp(argv[i], "--players") == 0) {
+      intArg(players);
+    } else if (std::strcmp(argv[i], "--frames") == 0) {
+      intArg(frames);
+    } else if (std::strcmp(argv[i], "--grid") == 0) {
+      intArg(gridSize);
+    } else if (std::strcmp(argv[i], "--seed") == 0) {
+      int value;
+      intArg(value);
+      seed = static_cast<unsigned>(value);
+    } else {
+      usage(argv[0]);
+    }
+  }
+  // Ids are a single byte on the wire (cycles::Id is sf::Uint8, 0 means an
+  // empty cell), so the game cannot address more than 254 players at once;
+  // scale beyond that would need a wider Id first
+  if (players > 254) {
+    std::fprintf(stderr, "clamping --players %d to 254 (Id is one byte)\n",
+                 players);
+    players = 254;
+  }
+
+  Configuration conf(writeConfig(gridSize, gridSize, players));
+  Game game(conf);
+  std::mt19937 rng(seed);
+  int spawned = 0;
+  for (int i = 0; i < players; ++i) {
+    spawnPlayer(game, conf, rng, spawned++);
+  }
+
+  std::vector<double> frameMicros;
+  frameMicros.reserve(frames);
+  int deaths = 0;
+  for (int frame = 0; frame < frames; ++frame) {
+    game.setFrame(frame);
+    auto directions = scriptedDirections(game, conf, rng);
+    const auto start = std::chrono::steady_clock::now();
+    game.movePlayers(directions);
+    const auto stop = std::chrono::steady_clock::now();
+    game.clearChangedCells();
+    frameMicros.push_back(
+        std::chrono::duration<double, std::micro>(stop - start).count());
+    if (!checkGridInvariant(game.getGrid(), game.getPlayers(), conf, frame)) {
+      return 1;
+    }
+    // Respawn the players that died this frame so load stays constant.
+    // Note idCounter wraps the Uint8 range on very long runs; keep
+    // frames * death rate under ~250 spawns or ids would collide.
+    while (static_cast<int>(game.getPlayers().size()) < players) {
+      if (spawned >= 254) {
+        break;
+      }
+      spawnPlayer(game, conf, rng, spawned++);
+      deaths++;
+    }
+  }
+
+  std::sort(frameMicros.begin(), frameMicros.end());
+  const double total =
+      std::accumulate(frameMicros.begin(), frameMicros.end(), 0.0);
+  std::printf("players=%d grid=%dx%d frames=%d deaths=%d\n", players, gridSize,
+              gridSize, frames, deaths);
+  std::printf("movePlayers us/frame: mean=%.2f p50=%.2f p90=%.2f p99=%.2f "
+              "max=%.2f\n",
+              total / frameMicros.size(), percentile(frameMicros, 0.50),
+              percentile(frameMicros, 0.90), percentile(frameMicros, 0.99),
+              frameMicros.back());
+  std::printf("all invariants held\n");
+  return 0;
+}
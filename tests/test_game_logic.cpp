@@ -1,5 +1,6 @@
 //GTest tests for game logic
 #include"server/game_logic.h"
+#include"server/replay.h"
 #include"gtest/gtest.h"
 #include<fstream>
 using cycles::Id;
@@ -65,14 +66,14 @@ maxClients: 60
   return temp_file;
 }
 
-bool test_grid(std::vector<sf::Uint8> grid, std::map<Id, Player> players, Configuration conf) {
+bool test_grid(std::vector<sf::Uint8> grid, std::vector<Player> players, Configuration conf) {
   int GRID_HEIGHT = conf.gridHeight;
   int GRID_WIDTH = conf.gridWidth;
   std::vector<sf::Uint8> true_grid(GRID_HEIGHT * GRID_WIDTH, 0);
-  for (auto &[id, player] : players) {
-    true_grid[player.position.y * GRID_WIDTH + player.position.x] = id;
+  for (auto &player : players) {
+    true_grid[player.position.y * GRID_WIDTH + player.position.x] = player.id;
     for (auto tail : player.tail) {
-      true_grid[tail.y * GRID_WIDTH + tail.x] = id;
+      true_grid[tail.y * GRID_WIDTH + tail.x] = player.id;
     }
   }
   for (int i = 0; i < GRID_HEIGHT * GRID_WIDTH; i++) {
@@ -89,9 +90,9 @@ TEST(GameLogicTest, AddPlayer) {
   Configuration conf(conf_file);
   Game game(conf);
   Id id = game.addPlayer("player1");
-  auto players = game.getPlayers();
-  EXPECT_EQ(players.size(), 1);
-  EXPECT_EQ(players[id].name, "player1");
+  EXPECT_EQ(game.getPlayers().size(), 1u);
+  ASSERT_TRUE(game.hasPlayer(id));
+  EXPECT_EQ(game.getPlayer(id).name, "player1");
 }
 
 TEST(GameLogicTest, RemovePlayer) {
@@ -102,12 +103,12 @@ TEST(GameLogicTest, RemovePlayer) {
   Id id = game.addPlayer("player1");
   Id id2 = game.addPlayer("player2");
   game.removePlayer(id);
-  auto players = game.getPlayers();
-  EXPECT_EQ(players.size(), 1);
-  EXPECT_EQ(players[id2].name, "player2");
+  EXPECT_EQ(game.getPlayers().size(), 1u);
+  EXPECT_FALSE(game.hasPlayer(id));
+  ASSERT_TRUE(game.hasPlayer(id2));
+  EXPECT_EQ(game.getPlayer(id2).name, "player2");
   game.removePlayer(id2);
-  players = game.getPlayers();
-  EXPECT_EQ(players.size(), 0);
+  EXPECT_EQ(game.getPlayers().size(), 0u);
 }
 
 TEST(GameLogicTest, MovePlayers) {
@@ -120,11 +121,11 @@ TEST(GameLogicTest, MovePlayers) {
   std::map<Id, Direction> directions;
   directions[id] = Direction::north;
   directions[id2] = Direction::south;
-  auto players_before = game.getPlayers();
+  auto position_before = game.getPlayer(id).position;
+  auto position2_before = game.getPlayer(id2).position;
   game.movePlayers(directions);
-  auto players = game.getPlayers();
-  EXPECT_EQ(players[id].position, players_before[id].position + sf::Vector2i(0, -1));
-  EXPECT_EQ(players[id2].position, players_before[id2].position + sf::Vector2i(0, 1));
+  EXPECT_EQ(game.getPlayer(id).position, position_before + sf::Vector2i(0, -1));
+  EXPECT_EQ(game.getPlayer(id2).position, position2_before + sf::Vector2i(0, 1));
 }
 
 TEST(GameLogicTest, GameOver){
@@ -140,6 +141,59 @@ TEST(GameLogicTest, GameOver){
   EXPECT_TRUE(game.isGameOver());
 }
 
+TEST(GameLogicTest, ReplayRoundTrip){
+  // Record a short game, play it back into a fresh Game and check that the
+  // final grid and player set match the original
+  std::string conf_file = writeConfig();
+  Configuration conf(conf_file);
+  Game recorded(conf);
+  Game played(conf);
+  // tmpnam returns a static buffer; copy before the next tmpnam call below
+  std::string replay_file = std::tmpnam(nullptr);
+  {
+    ReplayRecorder recorder(replay_file, conf);
+    Id id = recorded.addPlayer("player1", {10, 10}, sf::Color(200, 50, 50));
+    recorder.recordJoin(0, recorded.getPlayer(id));
+    Id id2 = recorded.addPlayer("player2", {50, 50}, sf::Color(50, 200, 50));
+    recorder.recordJoin(0, recorded.getPlayer(id2));
+    for (int frame = 0; frame < 100; frame++) {
+      std::map<Id, Direction> directions;
+      directions[id] = Direction::east;
+      directions[id2] = (frame % 2) ? Direction::south : Direction::east;
+      recorded.setFrame(frame);
+      recorder.recordTick(frame, directions);
+      recorded.movePlayers(directions);
+      recorded.clearChangedCells();
+    }
+    recorder.recordLeave(100, id);
+    recorded.removePlayer(id);
+  }
+  ASSERT_TRUE(playReplay(replay_file, conf, played));
+  // A mismatched grid configuration must be rejected, not played back.
+  // Skipped in CYCLES_FIXED_GRID builds, where Game refuses a non-matching
+  // grid size at construction already.
+#ifndef CYCLES_FIXED_GRID_WIDTH
+  std::string small_yaml = R"(
+gameHeight: 1000
+gameWidth: 1000
+gameBannerHeight: 100
+gridHeight: 50
+gridWidth: 50
+maxClients: 60
+)";
+  std::string small_file = std::tmpnam(nullptr);
+  {
+    std::ofstream out(small_file);
+    out << small_yaml;
+  }
+  Configuration small_conf(small_file);
+  Game mismatched(small_conf);
+  EXPECT_FALSE(playReplay(replay_file, small_conf, mismatched));
+#endif
+  EXPECT_EQ(played.getGrid(), recorded.getGrid());
+  EXPECT_EQ(played.getPlayers().size(), recorded.getPlayers().size());
+}
+
 TEST(GameLogicTest, Grid){
   // Write some yaml conf to a temp file
   std::string conf_file = writeConfig();
@@ -152,6 +206,6 @@ TEST(GameLogicTest, Grid){
   directions[id2] = Direction::south;
   game.movePlayers(directions);
   auto grid = game.getGrid();
-  auto players = game.getPlayers();
-  EXPECT_TRUE(test_grid(grid, players, conf));
+  game.publishSnapshot();
+  EXPECT_TRUE(test_grid(grid, game.getSnapshot()->players, conf));
 }